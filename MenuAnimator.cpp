@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "MenuAnimator.h"
+
+MenuAnimator::MenuAnimator(uint16_t frame_interval)
+: _p_transition(nullptr),
+  _start(0),
+  _duration(0),
+  _frame_interval(frame_interval ? frame_interval : 1),
+  _frame_num(0),
+  _frames_drawn(0),
+  _frames_dropped(0) {
+}
+
+void MenuAnimator::start(MenuTransition const& transition, uint32_t now,
+                         uint16_t duration) {
+    _p_transition = &transition;
+    _start = now;
+    _duration = duration;
+    _frame_num = 0;
+    if (_duration == 0)
+        finish();
+    else
+        draw(0);
+}
+
+bool MenuAnimator::tick(uint32_t now) {
+    if (_p_transition == nullptr)
+        return false;
+
+    // Unsigned differences keep working when the clock wraps around
+    const uint32_t elapsed = now - _start;
+    if (elapsed >= _duration) {
+        // Frames due between the last one drawn and the end
+        _frames_dropped += (_duration - 1) / _frame_interval - _frame_num;
+        finish();
+        return false;
+    }
+
+    const uint16_t frame_num = elapsed / _frame_interval;
+    if (frame_num <= _frame_num)
+        return true;
+
+    _frames_dropped += frame_num - _frame_num - 1;
+    _frame_num = frame_num;
+    draw(uint8_t(elapsed * MENU_TRANSITION_END / _duration));
+    return true;
+}
+
+void MenuAnimator::finish() {
+    if (_p_transition == nullptr)
+        return;
+    draw(MENU_TRANSITION_END);
+    _p_transition = nullptr;
+}
+
+void MenuAnimator::cancel() {
+    _p_transition = nullptr;
+}
+
+bool MenuAnimator::is_running() const {
+    return _p_transition != nullptr;
+}
+
+uint32_t MenuAnimator::get_frames_drawn() const {
+    return _frames_drawn;
+}
+
+uint32_t MenuAnimator::get_frames_dropped() const {
+    return _frames_dropped;
+}
+
+void MenuAnimator::draw(uint8_t progress) {
+    ++_frames_drawn;
+    _p_transition->draw_frame(progress);
+}
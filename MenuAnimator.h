@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#ifndef MENUANIMATOR_H
+#define MENUANIMATOR_H
+
+#include <stdint.h>
+
+//! \brief The progress of the last frame of a transition
+static const uint8_t MENU_TRANSITION_END = 255;
+
+//! \brief A transition a renderer draws frame by frame
+//!
+//! Renderers describe an animation, e.g. sliding from one component name
+//! to the next, as a MenuTransition and hand it to a MenuAnimator instead
+//! of drawing every frame in a loop with delays.
+//!
+//! \see MenuAnimator
+class MenuTransition {
+public:
+    //! \brief Draws the frame at `progress`
+    //!
+    //! \param[in] progress How far the transition is, from 0 to
+    //!                     MENU_TRANSITION_END. The last frame drawn is
+    //!                     always MENU_TRANSITION_END.
+    virtual void draw_frame(uint8_t progress) const = 0;
+};
+
+//! \brief Plays a MenuTransition from the main loop without blocking
+//!
+//! A renderer starts a transition from its render methods; the main loop
+//! then calls tick with the current time, which draws a frame when one is
+//! due and returns at once otherwise, so input keeps being handled while
+//! the transition plays. When input arrives the loop can call finish to
+//! jump to the end before acting on it, or just let the next render start
+//! a new transition from wherever the screen is.
+//!
+//! Frames are due every `frame_interval` time units after the start. When
+//! the loop doesn't tick in time the late frames are skipped and counted
+//! as dropped; the progress of the frame drawn follows the clock, so a
+//! transition always takes its duration. Times are in whatever unit the
+//! caller uses, e.g. millis(), and may wrap around.
+class MenuAnimator {
+public:
+    //! \brief Construct a MenuAnimator
+    //! \param[in] frame_interval The time between two frames.
+    explicit MenuAnimator(uint16_t frame_interval);
+
+    //! \brief Starts `transition` and draws its first frame
+    //!
+    //! A transition already playing is abandoned without drawing its last
+    //! frame.
+    //!
+    //! \param[in] transition The transition to play. It must stay alive
+    //!                       until the transition ends.
+    //! \param[in] now The current time.
+    //! \param[in] duration The time until the last frame.
+    void start(MenuTransition const& transition, uint32_t now,
+               uint16_t duration);
+
+    //! \brief Draws the frame due at `now`, if any
+    //! \returns true while the transition is playing.
+    bool tick(uint32_t now);
+
+    //! \brief Draws the last frame of the playing transition and stops it
+    void finish();
+
+    //! \brief Stops the playing transition without drawing
+    void cancel();
+
+    bool is_running() const;
+
+    //! \brief Returns the number of frames drawn since construction
+    uint32_t get_frames_drawn() const;
+
+    //! \brief Returns the number of due frames that were skipped because
+    //! tick came late, since construction
+    uint32_t get_frames_dropped() const;
+
+private:
+    void draw(uint8_t progress);
+
+private:
+    MenuTransition const* _p_transition;
+    uint32_t _start;
+    uint16_t _duration;
+    uint16_t _frame_interval;
+    uint16_t _frame_num;
+    uint32_t _frames_drawn;
+    uint32_t _frames_dropped;
+};
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "MenuArena.h"
+
+MenuArena::MenuArena(void* buffer, size_t size)
+: _buffer(static_cast<uint8_t*>(buffer)),
+  _size(size),
+  _used(0),
+  _p_last(nullptr),
+  _has_failed(false) {
+    // Skip to the first aligned byte
+    const size_t skip = round_up(uintptr_t(_buffer)) - uintptr_t(_buffer);
+    if (_buffer == nullptr || skip > _size) {
+        _size = 0;
+        return;
+    }
+    _buffer += skip;
+    _size -= skip;
+}
+
+MenuArena::~MenuArena() {
+    clear();
+}
+
+Menu* MenuArena::make_menu(const char* name, menu_index_t num_components,
+                           MenuComponent::ComponentCbPtr on_activate,
+                           MenuComponent::ComponentCbPtr on_current) {
+    // Check the whole block fits first, so a failure leaves no orphan
+    if (_used + menu_size_of(num_components) > _size) {
+        _has_failed = true;
+        return nullptr;
+    }
+    Menu* p_menu = make<Menu>(name, on_activate, on_current);
+    p_menu->set_storage(make_components(num_components), num_components);
+    return p_menu;
+}
+
+MenuComponent** MenuArena::make_components(menu_index_t num_components) {
+    return static_cast<MenuComponent**>(
+        allocate(num_components * sizeof(MenuComponent*)));
+}
+
+void MenuArena::clear() {
+    while (_p_last != nullptr) {
+        Object* p_object = _p_last;
+        _p_last = p_object->p_prev;
+        p_object->destroy(p_object);
+    }
+    _used = 0;
+    _has_failed = false;
+}
+
+size_t MenuArena::get_size() const {
+    return _size;
+}
+
+size_t MenuArena::get_used() const {
+    return _used;
+}
+
+bool MenuArena::has_failed() const {
+    return _has_failed;
+}
+
+void* MenuArena::allocate(size_t size) {
+    size = round_up(size);
+    if (size > _size - _used) {
+        _has_failed = true;
+        return nullptr;
+    }
+    void* p = _buffer + _used;
+    _used += size;
+    return p;
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#ifndef MENUARENA_H
+#define MENUARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#ifdef __AVR__
+#include <new.h>
+#else
+#include <new>
+#endif
+
+#include "MenuSystem.h"
+
+//! \brief Builds a menu tree in one caller supplied buffer
+//!
+//! A MenuArena constructs components one after the other in its buffer,
+//! each menu followed by its child list, so building a tree makes no heap
+//! allocation: add never reallocates a list made by make_menu, and a
+//! MenuSystem constructed around an arena root doesn't allocate one.
+//! Construction fails with nullptr once the buffer is full; add refuses
+//! null components, so check has_failed once the tree is built.
+//!
+//! The arena destroys what it built, in reverse order, when it's cleared
+//! or destroyed. Destroy the MenuSystem using the tree first.
+//!
+//! Size the buffer with size_of and menu_size_of:
+//!
+//! \code
+//! static const size_t ARENA_SIZE = MenuArena::menu_size_of(2)
+//!     + MenuArena::menu_size_of(1)
+//!     + MenuArena::size_of<MenuItem>()
+//!     + MenuArena::size_of<NumericMenuItem>();
+//! alignas(void*) static uint8_t buffer[ARENA_SIZE];
+//!
+//! MenuArena arena(buffer, sizeof(buffer));
+//! Menu* p_root = arena.make_menu("Main", 2);
+//! Menu* p_sound = arena.make_menu("Sound", 1);
+//! p_root->add(arena.make<MenuItem>("Info", on_info));
+//! p_root->add(p_sound);
+//! p_sound->add(arena.make<NumericMenuItem>("Volume", 50, 0, 100, 1));
+//! MenuSystem ms(*p_root, renderer);
+//! \endcode
+class MenuArena {
+public:
+    //! Every block in the arena starts at a multiple of ALIGN bytes
+    static constexpr size_t ALIGN = alignof(void*);
+
+    //! \brief Construct a MenuArena
+    //! \param[in] buffer The storage, ideally aligned to ALIGN; an
+    //!                   unaligned start is skipped.
+    //! \param[in] size The number of bytes of buffer.
+    MenuArena(void* buffer, size_t size);
+    ~MenuArena();
+
+    //! \brief Constructs a T in the arena
+    //!
+    //! \returns the object, or nullptr if the arena is full.
+    template <typename T, typename... Args>
+    T* make(Args const&... args);
+
+    //! \brief Constructs a Menu whose child list of `num_components`
+    //! entries follows it in the arena
+    //!
+    //! \returns the menu, or nullptr if the arena is full.
+    Menu* make_menu(const char* name, menu_index_t num_components,
+                    MenuComponent::ComponentCbPtr on_activate=nullptr,
+                    MenuComponent::ComponentCbPtr on_current=nullptr);
+
+    //! \brief Allocates a child list of `num_components` entries
+    //!
+    //! \returns the list, or nullptr if the arena is full.
+    //!
+    //! \see Menu::set_storage
+    MenuComponent** make_components(menu_index_t num_components);
+
+    //! \brief Destroys everything built in the arena, last first, and
+    //! empties it
+    void clear();
+
+    size_t get_size() const;
+    size_t get_used() const;
+
+    //! \brief Returns true if a construction failed since the last clear
+    bool has_failed() const;
+
+    //! \brief Returns the bytes `count` objects of type T take in an arena
+    template <typename T>
+    static constexpr size_t size_of(size_t count=1) {
+        return count * (round_up(sizeof(Object)) + round_up(sizeof(T)));
+    }
+
+    //! \brief Returns the bytes make_menu takes for a menu of
+    //! `num_components` children
+    static constexpr size_t menu_size_of(menu_index_t num_components) {
+        return size_of<Menu>()
+            + round_up(num_components * sizeof(MenuComponent*));
+    }
+
+private:
+    //! Precedes every object with a destructor
+    struct Object {
+        Object* p_prev;
+        void (*destroy)(Object* p_object);
+    };
+
+    static constexpr size_t round_up(size_t size) {
+        return (size + ALIGN - 1) / ALIGN * ALIGN;
+    }
+
+    template <typename T>
+    static void destroy(Object* p_object) {
+        reinterpret_cast<T*>(p_object + 1)->~T();
+    }
+
+    //! \brief Takes `size` bytes, rounded up to ALIGN, or returns nullptr
+    void* allocate(size_t size);
+
+private:
+    uint8_t* _buffer;
+    size_t _size;
+    size_t _used;
+    //! The last object with a destructor
+    Object* _p_last;
+    bool _has_failed;
+};
+
+template <typename T, typename... Args>
+T* MenuArena::make(Args const&... args) {
+    static_assert(alignof(T) <= ALIGN,
+                  "MenuArena can't align objects of this type");
+    Object* p_object = static_cast<Object*>(
+        allocate(round_up(sizeof(Object)) + sizeof(T)));
+    if (p_object == nullptr)
+        return nullptr;
+
+    T* p = new (p_object + 1) T(args...);
+    p_object->p_prev = _p_last;
+    p_object->destroy = destroy<T>;
+    _p_last = p_object;
+    return p;
+}
+
+#endif
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "MenuEventQueue.h"
+
+// The producer writes an event before publishing the new head and the
+// consumer reads events before publishing the new tail, so each side only
+// sees slots the other is done with.
+#ifdef __AVR__
+static inline uint8_t load_acquire(MenuEventQueueIndex const& index) {
+    const uint8_t value = index;
+    asm volatile("" ::: "memory");
+    return value;
+}
+
+static inline void store_release(MenuEventQueueIndex& index, uint8_t value) {
+    asm volatile("" ::: "memory");
+    index = value;
+}
+
+static inline uint8_t load_own(MenuEventQueueIndex const& index) {
+    return index;
+}
+#else
+static inline uint8_t load_acquire(MenuEventQueueIndex const& index) {
+    return index.load(std::memory_order_acquire);
+}
+
+static inline void store_release(MenuEventQueueIndex& index, uint8_t value) {
+    index.store(value, std::memory_order_release);
+}
+
+static inline uint8_t load_own(MenuEventQueueIndex const& index) {
+    return index.load(std::memory_order_relaxed);
+}
+#endif
+
+MenuEventQueue::MenuEventQueue(MenuEvent* buffer, uint8_t size)
+: _buffer(size != 0 ? buffer : nullptr),
+  _mask(0),
+  _head(0),
+  _tail(0),
+  _num_dropped(0) {
+    uint8_t capacity = 1;
+    while (capacity < MENU_EVENT_QUEUE_MAX && capacity * 2 <= size)
+        capacity *= 2;
+    _mask = capacity - 1;
+}
+
+uint8_t MenuEventQueue::get_capacity() const {
+    return _buffer != nullptr ? _mask + 1 : 0;
+}
+
+bool MenuEventQueue::push(MenuEvent event) {
+    const uint8_t head = load_own(_head);
+    if (_buffer == nullptr || uint8_t(head - load_acquire(_tail)) > _mask) {
+        if (_num_dropped != UINT16_MAX)
+            _num_dropped = _num_dropped + 1;
+        return false;
+    }
+    _buffer[head & _mask] = event;
+    store_release(_head, head + 1);
+    return true;
+}
+
+uint8_t MenuEventQueue::pop(MenuEvent* events, uint8_t max_events) {
+    const uint8_t tail = load_own(_tail);
+    uint8_t num_events = load_acquire(_head) - tail;
+    if (num_events > max_events)
+        num_events = max_events;
+    for (uint8_t i = 0; i < num_events; ++i)
+        events[i] = _buffer[(tail + i) & _mask];
+    store_release(_tail, tail + num_events);
+    return num_events;
+}
+
+bool MenuEventQueue::drain(MenuSystem& ms, bool loop) {
+    const uint8_t tail = load_own(_tail);
+    const uint8_t num_events = load_acquire(_head) - tail;
+    if (num_events == 0)
+        return false;
+
+    // The slots stay ours until the tail moves past them
+    const uint8_t start = tail & _mask;
+    const uint8_t num_first = num_events < get_capacity() - start
+        ? num_events : get_capacity() - start;
+    const bool displayed = ms.process(_buffer + start, num_first, _buffer,
+                                      num_events - num_first, loop);
+
+    store_release(_tail, tail + num_events);
+    return displayed;
+}
+
+uint8_t MenuEventQueue::get_size() const {
+    return uint8_t(load_acquire(_head) - load_acquire(_tail));
+}
+
+uint16_t MenuEventQueue::get_num_dropped() const {
+    return _num_dropped;
+}
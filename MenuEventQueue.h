@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#ifndef MENUEVENTQUEUE_H
+#define MENUEVENTQUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "MenuSystem.h"
+
+// AVR has no <atomic>, but byte loads and stores are atomic on its single
+// core; MenuEventQueue.cpp adds the compiler barriers.
+#ifdef __AVR__
+typedef volatile uint8_t MenuEventQueueIndex;
+typedef volatile uint16_t MenuEventQueueCount;
+#else
+#include <atomic>
+typedef std::atomic<uint8_t> MenuEventQueueIndex;
+typedef std::atomic<uint16_t> MenuEventQueueCount;
+#endif
+
+//! \brief Largest capacity of a MenuEventQueue
+#define MENU_EVENT_QUEUE_MAX 128
+
+//! \brief Lock-free ring buffer of MenuEvent from one producer to one
+//! consumer
+//!
+//! The producer, usually an interrupt handler or an input thread, calls
+//! push; the UI loop calls drain, which hands the queued events to
+//! MenuSystem::process. Events arriving while the loop is busy rendering
+//! wait in the queue instead of being lost. Neither side ever blocks or
+//! disables interrupts.
+//!
+//! Exactly one context may push and exactly one may pop or drain.
+//!
+//! \code
+//! MenuEvent events[16];
+//! MenuEventQueue queue(events, 16);
+//!
+//! void on_encoder() { queue.push(MENU_EVENT_NEXT); }  // ISR
+//! void loop() { queue.drain(ms); }
+//! \endcode
+//!
+//! \see MenuSystem::process
+class MenuEventQueue {
+public:
+    //! \brief Construct a MenuEventQueue
+    //! \param[in] buffer Storage for the queued events, kept by the queue.
+    //! \param[in] size The number of events in buffer. Only the largest
+    //!                 power of two up to size and MENU_EVENT_QUEUE_MAX is
+    //!                 used. With no buffer or a size of 0 the capacity is
+    //!                 0 and push always fails.
+    MenuEventQueue(MenuEvent* buffer, uint8_t size);
+
+    //! \brief Returns the number of events the queue holds when full
+    uint8_t get_capacity() const;
+
+    //! \brief Queues an event; producer side
+    //! \returns false, dropping the event, if the queue is full.
+    bool push(MenuEvent event);
+
+    //! \brief Dequeues up to max_events events, oldest first; consumer side
+    //! \returns The number of events dequeued.
+    uint8_t pop(MenuEvent* events, uint8_t max_events);
+
+    //! \brief Passes every queued event to ms.process; consumer side
+    //!
+    //! The events are processed in place, in one call to process that
+    //! displays at most once, also when they wrap around the end of the
+    //! buffer.
+    //!
+    //! \param[in] ms The menu system receiving the events.
+    //! \param[in] loop Passed to MenuSystem::process.
+    //! \returns true if the menu changed and was displayed.
+    bool drain(MenuSystem& ms, bool loop=false);
+
+    //! \brief Returns the number of queued events; exact only on the
+    //! consumer side
+    uint8_t get_size() const;
+
+    //! \brief Returns the number of events push dropped because the queue
+    //! was full, saturating at UINT16_MAX
+    //!
+    //! On AVR read it with interrupts disabled if an ISR pushes.
+    uint16_t get_num_dropped() const;
+
+private:
+    MenuEvent* _buffer;
+    uint8_t _mask;
+    //! Free running counts of pushed and popped events; written only by
+    //! the producer and the consumer respectively
+    MenuEventQueueIndex _head;
+    MenuEventQueueIndex _tail;
+    //! Written only by the producer
+    MenuEventQueueCount _num_dropped;
+};
+
+#endif
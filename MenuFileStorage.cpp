@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+// AVR boards have no file system; their sketches use EEPROM instead.
+#ifndef __AVR__
+
+#include "MenuFileStorage.h"
+#include <string.h>
+
+static const uint8_t ERASED = 0xFF;
+
+MenuFileStorage::MenuFileStorage(const char* path)
+: _file(fopen(path, "r+b")),
+  _num_writes(0),
+  _bytes_written(0) {
+    if (_file == nullptr)
+        _file = fopen(path, "w+b");
+}
+
+MenuFileStorage::~MenuFileStorage() {
+    if (_file != nullptr)
+        fclose(_file);
+}
+
+bool MenuFileStorage::read(uint16_t address, void* data, uint16_t size) {
+    if (_file == nullptr || fseek(_file, address, SEEK_SET) != 0)
+        return false;
+    const size_t num_read = fread(data, 1, size, _file);
+    // Past the end of the file the storage is still erased
+    memset((uint8_t*) data + num_read, ERASED, size - num_read);
+    return true;
+}
+
+bool MenuFileStorage::write(uint16_t address, void const* data,
+                            uint16_t size) {
+    if (_file == nullptr || fseek(_file, 0, SEEK_END) != 0)
+        return false;
+
+    // Fill a gap before address as erased bytes rather than zeros
+    for (long end = ftell(_file); end >= 0 && end < address; ++end) {
+        if (fputc(ERASED, _file) == EOF)
+            return false;
+    }
+
+    ++_num_writes;
+    _bytes_written += size;
+    return fseek(_file, address, SEEK_SET) == 0
+        && fwrite(data, 1, size, _file) == size
+        && fflush(_file) == 0;
+}
+
+uint32_t MenuFileStorage::get_num_writes() const {
+    return _num_writes;
+}
+
+uint32_t MenuFileStorage::get_bytes_written() const {
+    return _bytes_written;
+}
+
+#endif
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#ifndef MENUFILESTORAGE_H
+#define MENUFILESTORAGE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "MenuStore.h"
+
+//! \brief MenuStorage kept in a file, for hosts and boards with a file
+//! system
+//!
+//! The file is created on first use. Bytes never written read as 0xFF, as
+//! in erased flash. Every write is flushed to the file before returning.
+class MenuFileStorage : public MenuStorage {
+public:
+    //! \brief Construct a MenuFileStorage
+    //! \param[in] path The file holding the bytes.
+    explicit MenuFileStorage(const char* path);
+    ~MenuFileStorage();
+
+    virtual bool read(uint16_t address, void* data, uint16_t size);
+    virtual bool write(uint16_t address, void const* data, uint16_t size);
+
+    //! \brief Returns the number of write calls since construction
+    uint32_t get_num_writes() const;
+
+    //! \brief Returns the number of bytes written since construction
+    uint32_t get_bytes_written() const;
+
+private:
+    FILE* _file;
+    uint32_t _num_writes;
+    uint32_t _bytes_written;
+};
+
+#endif
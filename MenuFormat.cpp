@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "MenuFormat.h"
+
+// Writes the digits of value, padded with zeros to at least min_digits,
+// followed by the terminator. Returns the number of digits written.
+static size_t format_digits(uint32_t value, uint8_t min_digits,
+                            char* buffer, size_t size) {
+    char digits[10];
+    uint8_t num_digits = 0;
+    do {
+        digits[num_digits++] = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+    while (num_digits < min_digits)
+        digits[num_digits++] = '0';
+
+    size_t length = 0;
+    while (num_digits > 0 && length + 1 < size)
+        buffer[length++] = digits[--num_digits];
+    buffer[length] = '\0';
+    return length;
+}
+
+size_t menu_format_int(int32_t value, char* buffer, size_t size) {
+    if (size == 0)
+        return 0;
+
+    size_t length = 0;
+    uint32_t magnitude = (uint32_t) value;
+    if (value < 0) {
+        magnitude = 0 - magnitude;
+        if (size > 1)
+            buffer[length++] = '-';
+    }
+    return length + format_digits(magnitude, 1, buffer + length,
+                                  size - length);
+}
+
+// Writes the sign, integer part and decimals of a magnitude split in an
+// integer part and a fraction already scaled to `decimals` digits.
+static size_t format_split(bool negative, uint32_t integer, uint32_t fraction,
+                           uint8_t decimals, char* buffer, size_t size) {
+    size_t length = 0;
+    if (negative && (integer != 0 || fraction != 0) && size > 1)
+        buffer[length++] = '-';
+    length += format_digits(integer, 1, buffer + length, size - length);
+    if (decimals == 0 || length + 1 >= size)
+        return length;
+
+    buffer[length++] = '.';
+    return length + format_digits(fraction, decimals,
+                                  buffer + length, size - length);
+}
+
+static uint32_t power_of_ten(uint8_t decimals) {
+    uint32_t scale = 1;
+    for (uint8_t i = 0; i < decimals; ++i)
+        scale *= 10;
+    return scale;
+}
+
+size_t menu_format_fixed(float value, uint8_t decimals,
+                         char* buffer, size_t size) {
+    if (size == 0)
+        return 0;
+    if (decimals > 6)
+        decimals = 6;
+
+    // NaN fails every comparison, so the clamp below would let it reach
+    // the cast
+    if (value != value) {
+        static const char nan[] = "nan";
+        size_t length = 0;
+        while (nan[length] != '\0' && length + 1 < size) {
+            buffer[length] = nan[length];
+            ++length;
+        }
+        buffer[length] = '\0';
+        return length;
+    }
+
+    const uint32_t scale = power_of_ten(decimals);
+    const bool negative = value < 0;
+    const float scaled = (negative ? -value : value) * scale + 0.5f;
+    const uint32_t magnitude = scaled >= 4294967295.0f
+        ? UINT32_MAX : (uint32_t) scaled;
+
+    return format_split(negative, magnitude / scale, magnitude % scale,
+                        decimals, buffer, size);
+}
+
+size_t menu_format_scaled(int32_t raw, uint32_t scale, uint8_t decimals,
+                          char* buffer, size_t size) {
+    if (size == 0)
+        return 0;
+    if (decimals > 6)
+        decimals = 6;
+
+    const bool negative = raw < 0;
+    const uint32_t magnitude = negative ? 0 - (uint32_t) raw : raw;
+    uint32_t integer = magnitude / scale;
+    const uint32_t remainder = magnitude % scale;
+
+    // Round the remainder to the requested decimals, carrying into the
+    // integer part when it rounds up to one. The product is done in two
+    // steps so a 16 bit fraction and 6 decimals don't overflow.
+    const uint32_t decimal_scale = power_of_ten(decimals);
+    uint32_t fraction = 0;
+    uint32_t rest = remainder;
+    for (uint8_t i = 0; i < decimals; ++i) {
+        rest *= 10;
+        fraction = fraction * 10 + rest / scale;
+        rest %= scale;
+    }
+    if (rest * 2 >= scale && ++fraction == decimal_scale) {
+        fraction = 0;
+        ++integer;
+    }
+
+    return format_split(negative, integer, fraction, decimals, buffer, size);
+}
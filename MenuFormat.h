@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#ifndef MENUFORMAT_H
+#define MENUFORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+//! \brief Writes a signed integer into a caller supplied buffer
+//!
+//! The result is always zero terminated and truncated to fit.
+//!
+//! \param[in] value The value to format.
+//! \param[out] buffer The buffer receiving the text.
+//! \param[in] size The size of buffer in bytes, terminator included.
+//! \returns The number of characters written, terminator excluded.
+size_t menu_format_int(int32_t value, char* buffer, size_t size);
+
+//! \brief Writes a float with a fixed number of decimals into a caller
+//! supplied buffer
+//!
+//! The value is rounded to the nearest representable decimal using integer
+//! arithmetic only; printf and float to string routines are not used, so
+//! nothing is pulled in besides a float multiply and conversion. Magnitudes
+//! that don't fit in 32 bits once scaled are clamped; NaN is written as
+//! "nan".
+//!
+//! \param[in] value The value to format.
+//! \param[in] decimals The number of decimals (at most 6).
+//! \param[out] buffer The buffer receiving the text.
+//! \param[in] size The size of buffer in bytes, terminator included.
+//! \returns The number of characters written, terminator excluded.
+size_t menu_format_fixed(float value, uint8_t decimals,
+                         char* buffer, size_t size);
+
+//! \brief Writes a fixed-point number into a caller supplied buffer
+//!
+//! The number is `raw / scale`, e.g. scale 256 for Q8.8 or 100 for two
+//! decimal places. Only integer arithmetic is used. The fraction is rounded
+//! to `decimals` digits.
+//!
+//! \param[in] raw The raw fixed-point value.
+//! \param[in] scale The scale of the representation.
+//! \param[in] decimals The number of decimals (at most 6).
+//! \param[out] buffer The buffer receiving the text.
+//! \param[in] size The size of buffer in bytes, terminator included.
+//! \returns The number of characters written, terminator excluded.
+size_t menu_format_scaled(int32_t raw, uint32_t scale, uint8_t decimals,
+                          char* buffer, size_t size);
+
+#endif
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "MenuStore.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const uint16_t HEADER_SIZE = 8;
+static const uint16_t CHECKSUM_OFFSET = 6;
+static const uint16_t VALUE_SIZE = 4;
+static const uint16_t SLOT_SIZE = VALUE_SIZE + 2;
+
+static void fletcher16(uint16_t& sum1, uint16_t& sum2, void const* data,
+                       size_t size) {
+    uint8_t const* bytes = (uint8_t const*) data;
+    while (size--) {
+        sum1 = (sum1 + *bytes++) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+}
+
+// Neither byte of the result is ever 0xFF, so erased memory fails a check
+static uint16_t fletcher16_result(uint16_t sum1, uint16_t sum2) {
+    return (sum2 << 8) | sum1;
+}
+
+MenuStore::MenuStore(MenuStorage& storage, uint16_t version,
+                     uint16_t address)
+: _storage(storage),
+  _version(version),
+  _address(address),
+  _slots(nullptr),
+  _num_slots(0),
+  _capacity(0),
+  _is_synced(false) {
+}
+
+MenuStore::~MenuStore() {
+    free(_slots);
+}
+
+bool MenuStore::add(MenuComponent* p_component) {
+    const MenuComponentKind kind = p_component->get_kind();
+    if (kind != MENU_COMPONENT_NUMERIC && kind != MENU_COMPONENT_STEPPED)
+        return false;
+
+    // Grow the list geometrically when it's full, like Menu::add
+    if (_num_slots == _capacity) {
+        if (_capacity == UINT16_MAX)
+            return false;
+        const uint16_t capacity = _capacity == 0 ? 4
+            : _capacity > UINT16_MAX / 2 ? UINT16_MAX : _capacity * 2;
+        Slot* p_slots = (Slot*) realloc(_slots, capacity * sizeof(Slot));
+        if (p_slots == nullptr)
+            return false;
+        _slots = p_slots;
+        _capacity = capacity;
+    }
+
+    _slots[_num_slots].p_component = p_component;
+    _slots[_num_slots].value = read_value(p_component);
+    ++_num_slots;
+    // The layout changed: the stored blob no longer matches
+    _is_synced = false;
+    return true;
+}
+
+uint16_t MenuStore::add_all(Menu& menu) {
+    // Generated children only exist while they're shown
+    if (menu.is_generated())
+        return 0;
+
+    uint16_t num_added = 0;
+    for (menu_index_t num = 0; num < menu.get_num_components(); ++num) {
+        MenuComponent* p_component =
+            const_cast<MenuComponent*>(menu.get_menu_component(num));
+        if (p_component->get_kind() == MENU_COMPONENT_MENU)
+            num_added += add_all(*static_cast<Menu*>(p_component));
+        else if (add(p_component))
+            ++num_added;
+    }
+    return num_added;
+}
+
+uint16_t MenuStore::get_num_slots() const {
+    return _num_slots;
+}
+
+uint16_t MenuStore::get_blob_size() const {
+    return HEADER_SIZE + _num_slots * SLOT_SIZE;
+}
+
+bool MenuStore::load() {
+    _is_synced = false;
+
+    uint8_t header[HEADER_SIZE];
+    uint8_t expected[HEADER_SIZE];
+    if (!_storage.read(_address, header, HEADER_SIZE))
+        return false;
+    fill_header(expected);
+    if (memcmp(header, expected, HEADER_SIZE) != 0)
+        return false;
+
+    // Slot values are only applied once every slot was read. Each slot
+    // checks out on its own, so a save torn by a reset only loses the
+    // slot it was writing, whose item keeps its value.
+    bool all_loaded = true;
+    for (uint16_t i = 0; i < _num_slots; ++i) {
+        uint8_t slot[SLOT_SIZE];
+        uint8_t expected_slot[SLOT_SIZE];
+        if (!_storage.read(_address + HEADER_SIZE + i * SLOT_SIZE,
+                           slot, SLOT_SIZE))
+            return false;
+        memcpy(&_slots[i].value, slot, VALUE_SIZE);
+        fill_slot(expected_slot, i, _slots[i].value);
+        if (memcmp(slot, expected_slot, SLOT_SIZE) != 0) {
+            _slots[i].value = read_value(_slots[i].p_component);
+            all_loaded = false;
+        }
+    }
+
+    for (uint16_t i = 0; i < _num_slots; ++i)
+        write_value(_slots[i].p_component, _slots[i].value);
+    // Setting a value may clamp it to the item's range
+    for (uint16_t i = 0; i < _num_slots; ++i)
+        _slots[i].value = read_value(_slots[i].p_component);
+    _is_synced = all_loaded;
+    return true;
+}
+
+bool MenuStore::is_dirty() const {
+    if (!_is_synced)
+        return true;
+    for (uint16_t i = 0; i < _num_slots; ++i) {
+        if (read_value(_slots[i].p_component) != _slots[i].value)
+            return true;
+    }
+    return false;
+}
+
+int16_t MenuStore::save() {
+    uint16_t num_written = 0;
+    for (uint16_t i = 0; i < _num_slots; ++i) {
+        const uint32_t value = read_value(_slots[i].p_component);
+        if (_is_synced && value == _slots[i].value)
+            continue;
+        uint8_t slot[SLOT_SIZE];
+        fill_slot(slot, i, value);
+        if (!_storage.write(_address + HEADER_SIZE + i * SLOT_SIZE,
+                            slot, SLOT_SIZE)) {
+            _is_synced = false;
+            return -1;
+        }
+        _slots[i].value = value;
+        ++num_written;
+    }
+    if (_is_synced)
+        return num_written;
+
+    // An unknown blob is rewritten whole, header last
+    uint8_t header[HEADER_SIZE];
+    fill_header(header);
+    _is_synced = _storage.write(_address, header, HEADER_SIZE);
+    return _is_synced ? num_written : -1;
+}
+
+uint32_t MenuStore::read_value(MenuComponent const* p_component) {
+    uint32_t value = 0;
+    if (p_component->get_kind() == MENU_COMPONENT_NUMERIC) {
+        const float number =
+            static_cast<NumericMenuItem const*>(p_component)->get_value();
+        memcpy(&value, &number, sizeof(number));
+    } else {
+        value = static_cast<SteppedMenuItem const*>(p_component)
+            ->get_step_num();
+    }
+    return value;
+}
+
+void MenuStore::write_value(MenuComponent* p_component, uint32_t value) {
+    if (p_component->get_kind() == MENU_COMPONENT_NUMERIC) {
+        float number;
+        memcpy(&number, &value, sizeof(number));
+        static_cast<NumericMenuItem*>(p_component)->set_value(number);
+    } else {
+        static_cast<SteppedMenuItem*>(p_component)->set_step_num(value);
+    }
+}
+
+void MenuStore::fill_header(uint8_t* header) const {
+    header[0] = 'M';
+    header[1] = 'S';
+    memcpy(header + 2, &_version, sizeof(_version));
+    memcpy(header + 4, &_num_slots, sizeof(_num_slots));
+    uint16_t sum1 = 0;
+    uint16_t sum2 = 0;
+    fletcher16(sum1, sum2, header + 2, CHECKSUM_OFFSET - 2);
+    const uint16_t check = fletcher16_result(sum1, sum2);
+    memcpy(header + CHECKSUM_OFFSET, &check, sizeof(check));
+}
+
+void MenuStore::fill_slot(uint8_t* slot, uint16_t slot_num,
+                          uint32_t value) const {
+    // The check also covers the version, the slot count and the slot
+    // number, so a slot left over from another layout fails it
+    uint16_t sum1 = 0;
+    uint16_t sum2 = 0;
+    fletcher16(sum1, sum2, &_version, sizeof(_version));
+    fletcher16(sum1, sum2, &_num_slots, sizeof(_num_slots));
+    fletcher16(sum1, sum2, &slot_num, sizeof(slot_num));
+    memcpy(slot, &value, VALUE_SIZE);
+    fletcher16(sum1, sum2, slot, VALUE_SIZE);
+    const uint16_t check = fletcher16_result(sum1, sum2);
+    memcpy(slot + VALUE_SIZE, &check, sizeof(check));
+}
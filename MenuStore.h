@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#ifndef MENUSTORE_H
+#define MENUSTORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "MenuSystem.h"
+
+//! \brief Byte addressed non-volatile memory, e.g. EEPROM or a flash page
+//!
+//! Implement it for the memory of the board; MenuFileStorage keeps the
+//! bytes in a file on hosts.
+//!
+//! \see MenuStore
+class MenuStorage {
+public:
+    //! \brief Reads `size` bytes at `address`
+    //! \returns true on success.
+    virtual bool read(uint16_t address, void* data, uint16_t size) = 0;
+
+    //! \brief Writes `size` bytes at `address`
+    //! \returns true on success.
+    virtual bool write(uint16_t address, void const* data,
+                       uint16_t size) = 0;
+};
+
+//! \brief Persists the values of NumericMenuItem and SteppedMenuItem
+//! components
+//!
+//! Each added item gets a 6 byte slot in a blob stored at a fixed address:
+//!
+//!     offset 0  "MS"
+//!            2  version (uint16_t)
+//!            4  number of slots (uint16_t)
+//!            6  Fletcher-16 checksum of bytes 2-5
+//!            8  slot 0, slot 1, ...
+//!
+//! A slot holds the value, 4 bytes, followed by the Fletcher-16 checksum
+//! of the version, the slot count, the slot number and the value.
+//! NumericMenuItem slots hold the float value, SteppedMenuItem slots the
+//! step number, in the byte order of the board. MenuStore remembers the
+//! values it last loaded or saved, so save only writes the slots whose
+//! value changed since.
+//!
+//! A blob written with another version or slot count fails the header
+//! check and load leaves every item at its constructor value. A slot torn
+//! by a reset during save fails its own check and only its item keeps its
+//! constructor value.
+//!
+//! Bump the version whenever the meaning of the slots changes.
+//!
+//! \see MenuStorage
+class MenuStore {
+public:
+    //! \brief Construct a MenuStore
+    //! \param[in] storage Where the blob is kept.
+    //! \param[in] version The layout version of the application.
+    //! \param[in] address The address of the blob in storage.
+    MenuStore(MenuStorage& storage, uint16_t version, uint16_t address=0);
+    ~MenuStore();
+
+    //! \brief Gives `p_component` the next slot
+    //!
+    //! \returns true if the component was added, false if it isn't a
+    //!          NumericMenuItem or SteppedMenuItem or the allocation failed.
+    bool add(MenuComponent* p_component);
+
+    //! \brief Adds every NumericMenuItem and SteppedMenuItem of `menu` and
+    //! its submenus, depth first in menu order
+    //! \returns The number of components added.
+    uint16_t add_all(Menu& menu);
+
+    uint16_t get_num_slots() const;
+
+    //! \brief Returns the number of bytes the blob takes in storage
+    uint16_t get_blob_size() const;
+
+    //! \brief Sets the items from the blob
+    //!
+    //! Items whose slot fails its check are left untouched; the next save
+    //! rewrites the whole blob.
+    //!
+    //! \returns true if a blob of this version and slot count was found;
+    //!          false otherwise, in which case the items are left
+    //!          untouched.
+    bool load();
+
+    //! \brief Returns true if a value changed since the last load or save
+    bool is_dirty() const;
+
+    //! \brief Writes the slots whose value changed since the last load or
+    //! save
+    //!
+    //! Each changed value costs one 6 byte write to its own slot, and
+    //! nothing else is written, so a cell wears only as often as the value
+    //! it holds changes: on an EEPROM rated for 100000 writes a value
+    //! saved 100 times a day lasts over 2.7 years, however often the
+    //! others change. The first save after a failed or partial load
+    //! writes the whole blob, header last.
+    //!
+    //! \returns The number of slots written, or -1 if the storage failed.
+    int16_t save();
+
+private:
+    struct Slot {
+        MenuComponent* p_component;
+        uint32_t value;
+    };
+
+    static uint32_t read_value(MenuComponent const* p_component);
+    static void write_value(MenuComponent* p_component, uint32_t value);
+    void fill_header(uint8_t* header) const;
+    void fill_slot(uint8_t* slot, uint16_t slot_num, uint32_t value) const;
+
+private:
+    MenuStorage& _storage;
+    uint16_t _version;
+    uint16_t _address;
+    Slot* _slots;
+    uint16_t _num_slots;
+    uint16_t _capacity;
+    //! True when the storage is known to hold the blob as _slots says
+    bool _is_synced;
+};
+
+#endif
@@ -4,28 +4,178 @@
  */
 
 #include "MenuSystem.h"
+#include "MenuFormat.h"
 #include <stdlib.h>
+#include <string.h>
 #include <string> 
 using namespace std;
 
 
+// *********************************************************
+// MenuStats
+// *********************************************************
+
+#ifdef MENUSYSTEM_STATS
+MenuStats menu_stats;
+
+static MenuStatsClockFnPtr stats_clock_fn = nullptr;
+
+void menu_stats_set_clock(MenuStatsClockFnPtr clock_fn) {
+    stats_clock_fn = clock_fn;
+}
+
+void menu_stats_clear() {
+    memset(&menu_stats, 0, sizeof(menu_stats));
+}
+
+void menu_stats_dump(MenuStatsPrintFnPtr print_fn) {
+    struct Line {
+        const char* name;
+        uint32_t value;
+    };
+    const Line lines[] = {
+        {"next", menu_stats.num_next},
+        {"prev", menu_stats.num_prev},
+        {"activate", menu_stats.num_activate},
+        {"back", menu_stats.num_back},
+        {"reset", menu_stats.num_reset},
+        {"events", menu_stats.num_events},
+        {"display", menu_stats.num_display},
+        {"on_activate", menu_stats.num_on_activate},
+        {"on_current", menu_stats.num_on_current},
+        {"render item", menu_stats.num_renders[MENU_COMPONENT_ITEM]},
+        {"render back", menu_stats.num_renders[MENU_COMPONENT_BACK]},
+        {"render numeric", menu_stats.num_renders[MENU_COMPONENT_NUMERIC]},
+        {"render stepped", menu_stats.num_renders[MENU_COMPONENT_STEPPED]},
+        {"render menu", menu_stats.num_renders[MENU_COMPONENT_MENU]},
+        {"render time", menu_stats.render_time},
+        {"render time max", menu_stats.render_time_max},
+        {"callback time", menu_stats.callback_time},
+        {"callback time max", menu_stats.callback_time_max},
+    };
+    char buffer[11];
+    for (Line const& line : lines) {
+        print_fn(line.name);
+        for (size_t length = strlen(line.name); length < 18; ++length)
+            print_fn(" ");
+        // Digits from the end of the buffer, uint32_t doesn't fit int32_t
+        char* p_digit = buffer + sizeof(buffer);
+        *--p_digit = '\0';
+        uint32_t value = line.value;
+        do {
+            *--p_digit = '0' + value % 10;
+            value /= 10;
+        } while (value != 0);
+        print_fn(p_digit);
+        print_fn("\r\n");
+    }
+}
+
+uint32_t menu_stats_now() {
+    return stats_clock_fn != nullptr ? stats_clock_fn() : 0;
+}
+
+static void add_time(uint32_t& total, uint32_t& max, uint32_t start) {
+    const uint32_t time = menu_stats_now() - start;
+    total += time;
+    if (time > max)
+        max = time;
+}
+
+void menu_stats_add_render_time(uint32_t start) {
+    add_time(menu_stats.render_time, menu_stats.render_time_max, start);
+}
+
+void menu_stats_add_callback_time(uint32_t start) {
+    add_time(menu_stats.callback_time, menu_stats.callback_time_max, start);
+}
+
+// Calls a component callback, counting and timing it
+static void call_counted(MenuComponent::ComponentCbPtr callback,
+                         MenuComponent* p_component, uint32_t& count) {
+    ++count;
+    const uint32_t start = menu_stats_now();
+    callback(p_component);
+    menu_stats_add_callback_time(start);
+}
+#define MENU_CALL(callback, p_component, count) \
+    call_counted(callback, p_component, menu_stats.count)
+#else
+#define MENU_CALL(callback, p_component, count) callback(p_component)
+#endif
+
 // *********************************************************
 // MenuComponent
 // *********************************************************
 
+#ifdef MENUSYSTEM_COMPACT
+// Slot 0 of both tables stays null and stands for "none".
+static MenuComponent::ComponentCbPtr callbacks[MENUSYSTEM_MAX_CALLBACKS];
+static Menu* menus[MENUSYSTEM_MAX_MENUS];
+static bool has_overflowed = false;
+
+bool menu_compact_has_overflowed() {
+    return has_overflowed;
+}
+
+static uint8_t register_callback(MenuComponent::ComponentCbPtr callback) {
+    if (callback == nullptr)
+        return 0;
+    for (uint16_t i = 1; i < MENUSYSTEM_MAX_CALLBACKS; ++i) {
+        if (callbacks[i] == callback)
+            return i;
+        if (callbacks[i] == nullptr) {
+            callbacks[i] = callback;
+            return i;
+        }
+    }
+    // The table is full: the callback is dropped
+    has_overflowed = true;
+    return 0;
+}
+
+static uint8_t register_menu(Menu* p_menu) {
+    for (uint16_t i = 1; i < MENUSYSTEM_MAX_MENUS; ++i) {
+        if (menus[i] == nullptr) {
+            menus[i] = p_menu;
+            return i;
+        }
+    }
+    // The table is full: the menu refuses children, which couldn't find
+    // their way back to it
+    has_overflowed = true;
+    return 0;
+}
+
 MenuComponent::MenuComponent(const char* name, ComponentCbPtr on_activate, ComponentCbPtr on_current)
 : _name(name),
+  _kind(MENU_COMPONENT_ITEM),
+  _is_active(false),
+  _is_current(false),
+  _on_activate_num(register_callback(on_activate)),
+  _on_current_num(register_callback(on_current)),
+  _parent_num(0) {
+}
+#else
+MenuComponent::MenuComponent(const char* name, ComponentCbPtr on_activate, ComponentCbPtr on_current)
+: _name(name),
+  _kind(MENU_COMPONENT_ITEM),
   _is_active(false),
   _is_current(false),
   _on_activate(on_activate),
   _on_current(on_current),
   _p_parent(nullptr){
 }
+#endif
 
 const char* MenuComponent::get_name() const {
     return _name;
 }
 
+MenuComponentKind MenuComponent::get_kind() const {
+    return static_cast<MenuComponentKind>(_kind);
+}
+
 void MenuComponent::set_name(const char* name) {
     _name = name;
 }
@@ -44,17 +194,53 @@ bool MenuComponent::is_current() const {
 
 void MenuComponent::set_current(bool is_current) {
     _is_current = is_current;
-    if (_is_current && _on_current != nullptr)
-      _on_current(this);
+    if (_is_current)
+      call_on_current();
 }
 
 Menu* MenuComponent::activate() {
-    if (_on_activate != nullptr)
-        _on_activate(this);
+    call_on_activate();
 
     return nullptr;
 }
 
+#ifdef MENUSYSTEM_COMPACT
+void MenuComponent::call_on_activate() {
+    if (_on_activate_num != 0)
+        MENU_CALL(callbacks[_on_activate_num], this, num_on_activate);
+}
+
+void MenuComponent::call_on_current() {
+    if (_on_current_num != 0)
+        MENU_CALL(callbacks[_on_current_num], this, num_on_current);
+}
+
+void MenuComponent::set_on_activate_cb(ComponentCbPtr on_activate) {
+    _on_activate_num = register_callback(on_activate);
+}
+
+void MenuComponent::set_on_current_cb(ComponentCbPtr on_current) {
+    _on_current_num = register_callback(on_current);
+}
+
+Menu const* MenuComponent::get_parent() const {
+    return menus[_parent_num];
+}
+
+void MenuComponent::set_parent(Menu* p_parent) {
+    _parent_num = p_parent != nullptr ? p_parent->_menu_num : 0;
+}
+#else
+void MenuComponent::call_on_activate() {
+    if (_on_activate != nullptr)
+        MENU_CALL(_on_activate, this, num_on_activate);
+}
+
+void MenuComponent::call_on_current() {
+    if (_on_current != nullptr)
+        MENU_CALL(_on_current, this, num_on_current);
+}
+
 void MenuComponent::set_on_activate_cb(ComponentCbPtr on_activate) {
     _on_activate = on_activate;
 }
@@ -63,13 +249,14 @@ void MenuComponent::set_on_current_cb(ComponentCbPtr on_current) {
     _on_current = on_current;
 }
 
-Menu const* MenuComponent::get_parent(){
+Menu const* MenuComponent::get_parent() const {
     return _p_parent;
 }
 
 void MenuComponent::set_parent(Menu* p_parent) {
     _p_parent = p_parent;
 }
+#endif
 
 // *********************************************************
 // Menu
@@ -77,11 +264,28 @@ void MenuComponent::set_parent(Menu* p_parent) {
 
 Menu::Menu(const char* name, ComponentCbPtr on_activate, ComponentCbPtr on_current)
   : MenuComponent(name, on_activate, on_current),
-  _p_current_component(nullptr),
   _menu_components(nullptr),
   _num_components(0),
+  _capacity(0),
   _current_component_num(0),
-  _previous_component_num(0) {
+  _previous_component_num(0),
+  _visible_count(0),
+  _first_visible_num(0),
+  _remembers_position(false),
+  _has_external_storage(false) {
+    _kind = MENU_COMPONENT_MENU;
+#ifdef MENUSYSTEM_COMPACT
+    _menu_num = register_menu(this);
+#endif
+}
+
+Menu::~Menu() {
+    if (!_has_external_storage)
+        free(_menu_components);
+#ifdef MENUSYSTEM_COMPACT
+    if (_menu_num != 0)
+        menus[_menu_num] = nullptr;
+#endif
 }
 
 bool Menu::next(bool loop) {
@@ -91,17 +295,15 @@ bool Menu::next(bool loop) {
         return false;
     } else if (_current_component_num != _num_components - 1) {
         _current_component_num++;
-        _p_current_component = _menu_components[_current_component_num];
-
-        _p_current_component->set_current();
-        _menu_components[_previous_component_num]->set_current(false);
+        get_component(_current_component_num)->set_current();
+        get_component(_previous_component_num)->set_current(false);
+        scroll_to_current();
         return true;
     } else if (loop) {
         _current_component_num = 0;
-        _p_current_component = _menu_components[_current_component_num];
-
-        _p_current_component->set_current();
-        _menu_components[_previous_component_num]->set_current(false);
+        get_component(_current_component_num)->set_current();
+        get_component(_previous_component_num)->set_current(false);
+        scroll_to_current();
 
         return true;
     }
@@ -115,18 +317,16 @@ bool Menu::prev(bool loop) {
         return false;
     } else if (_current_component_num != 0) {
         _current_component_num--;
-        _p_current_component = _menu_components[_current_component_num];
-
-        _p_current_component->set_current();
-        _menu_components[_previous_component_num]->set_current(false);
+        get_component(_current_component_num)->set_current();
+        get_component(_previous_component_num)->set_current(false);
+        scroll_to_current();
 
         return true;
     } else if (loop) {
         _current_component_num = _num_components - 1;
-        _p_current_component = _menu_components[_current_component_num];
-
-        _p_current_component->set_current();
-        _menu_components[_previous_component_num]->set_current(false);
+        get_component(_current_component_num)->set_current();
+        get_component(_previous_component_num)->set_current(false);
+        scroll_to_current();
 
         return true;
     }
@@ -137,7 +337,7 @@ Menu* Menu::activate_menucomponent() {
     if (!_num_components)
         return nullptr;
 
-    MenuComponent* pComponent = _menu_components[_current_component_num];
+    MenuComponent* pComponent = get_component(_current_component_num);
 
     if (pComponent == nullptr)
         return nullptr;
@@ -148,72 +348,381 @@ Menu* Menu::activate_menucomponent() {
 Menu* Menu::activate() {
     MenuComponent::activate();
     this->set_active(true);
-    _p_current_component = _num_components ? _menu_components[0] : nullptr;
-    if (_p_current_component)
-      _p_current_component->set_current();
+    if (!_remembers_position) {
+        _current_component_num = 0;
+    } else if (_current_component_num >= _num_components) {
+        // Components were removed while the menu wasn't shown
+        _current_component_num = _num_components ? _num_components - 1 : 0;
+    }
+    _previous_component_num = _current_component_num;
+    scroll_to_current();
+    if (_num_components)
+      get_component(_current_component_num)->set_current();
     return this;
 }
 
+void Menu::leave() {
+    if (!_remembers_position) {
+        reset();
+        return;
+    }
+    MenuComponent* p_current = get_current();
+    if (p_current) {
+        p_current->set_current(false);
+        p_current->set_active(false);
+    }
+}
+
+void Menu::set_remember_position(bool remember) {
+    _remembers_position = remember;
+}
+
+bool Menu::remembers_position() const {
+    return _remembers_position;
+}
+
 void Menu::reset() {
   // Makes first menuitem current
-  if(_p_current_component){
-    _p_current_component->set_current(false);
-    _p_current_component->set_active(false);
+  MenuComponent* p_current = get_current();
+  if (p_current) {
+    p_current->set_current(false);
+    p_current->set_active(false);
   }
   _previous_component_num = 0;
   _current_component_num = 0;
-  _p_current_component = _num_components ? _menu_components[0] : nullptr;
-  if (this->is_active() && _p_current_component){
-    _p_current_component->set_current();
+  _first_visible_num = 0;
+  if (this->is_active() && _num_components){
+    get_component(0)->set_current();
   }
 }
 
 // }
 
-void Menu::add(MenuComponent* p_component) {
+bool Menu::reserve(menu_index_t capacity) {
+    if (capacity <= _capacity)
+        return true;
+    if (_has_external_storage)
+        return false;
+
     // Resize menu component list, keeping existing items.
+    // If it fails, the current list is left untouched.
+    MenuComponent** p_components = (MenuComponent**) realloc(
+        _menu_components, capacity * sizeof(MenuComponent*));
+    if (p_components == nullptr)
+        return false;
+
+    _menu_components = p_components;
+    _capacity = capacity;
+    return true;
+}
+
+bool Menu::set_storage(MenuComponent** p_storage, menu_index_t capacity) {
+    if (capacity < _num_components)
+        return false;
+
+    if (_num_components)
+        memcpy(p_storage, _menu_components,
+               _num_components * sizeof(MenuComponent*));
+    if (!_has_external_storage)
+        free(_menu_components);
+    _menu_components = p_storage;
+    _capacity = capacity;
+    _has_external_storage = true;
+    return true;
+}
+
+bool Menu::grow() {
+    // Grow the list geometrically when it's full.
+    // If it fails, the list is left untouched.
+    if (_num_components < _capacity)
+        return true;
+    if (_capacity == MENU_INDEX_MAX)
+        return false;
+    menu_index_t capacity = _capacity == 0 ? 4
+        : _capacity > MENU_INDEX_MAX / 2 ? MENU_INDEX_MAX
+        : menu_index_t(_capacity * 2);
+    return reserve(capacity);
+}
+
+bool Menu::can_be_parent() const {
+#ifdef MENUSYSTEM_COMPACT
+    // A menu that didn't fit the menu table can't be found by its children
+    return _menu_num != 0;
+#else
+    return true;
+#endif
+}
+
+bool Menu::add(MenuComponent* p_component) {
     // If it fails, then the item is not added and the function returns.
-    _menu_components = (MenuComponent**) realloc(_menu_components,
-                                                (_num_components + 1)
-                                                * sizeof(MenuComponent*));
-    if (_menu_components == nullptr)
-      return;
+    if (p_component == nullptr || is_generated() || !can_be_parent()
+        || !grow())
+        return false;
 
     _menu_components[_num_components] = p_component;
 
-    // if (_num_components == 0) {
-    //   _p_current_component = p_component;
-    //   _p_current_component->_is_current = true;
-    // }
+    _num_components++;
+    p_component->set_parent(this);
+    // A displayed menu that was empty gets its cursor
+    if (_num_components == 1 && is_active())
+        p_component->_is_current = true;
+    return true;
+}
+
+bool Menu::insert(menu_index_t num, MenuComponent* p_component) {
+    if (num > _num_components || p_component == nullptr || is_generated()
+        || !can_be_parent() || !grow())
+        return false;
 
+    memmove(_menu_components + num + 1, _menu_components + num,
+            (_num_components - num) * sizeof(MenuComponent*));
+    _menu_components[num] = p_component;
+    // The cursor follows its component
+    if (_num_components > 0 && num <= _current_component_num)
+        ++_current_component_num;
     _num_components++;
     p_component->set_parent(this);
+    // A displayed menu that was empty gets its cursor
+    if (_num_components == 1 && is_active())
+        p_component->_is_current = true;
+
+    _previous_component_num = _current_component_num;
+    scroll_to_current();
+    return true;
+}
+
+bool Menu::remove_at(menu_index_t num) {
+    if (num >= _num_components || is_generated())
+        return false;
+
+    // MenuSystem would be left inside a detached menu
+    MenuComponent* p_component = _menu_components[num];
+    if (p_component->get_kind() == MENU_COMPONENT_MENU
+        && p_component->is_active())
+        return false;
+
+    memmove(_menu_components + num, _menu_components + num + 1,
+            (_num_components - num - 1) * sizeof(MenuComponent*));
+    _num_components--;
+
+    if (num < _current_component_num) {
+        --_current_component_num;
+    } else if (num == _current_component_num) {
+        // The next component takes the cursor, or the previous at the end
+        if (_current_component_num == _num_components
+            && _current_component_num > 0)
+            --_current_component_num;
+        if (_num_components > 0)
+            get_component(_current_component_num)->_is_current =
+                p_component->is_current();
+    }
+    p_component->_is_current = false;
+    p_component->set_active(false);
+    p_component->set_parent(nullptr);
+
+    _previous_component_num = _current_component_num;
+    scroll_to_current();
+    return true;
 }
 
-MenuComponent const* Menu::get_menu_component(uint8_t index) const {
-    return _menu_components[index];
+bool Menu::remove(MenuComponent* p_component) {
+    return remove_at(get_component_num(p_component));
+}
+
+bool Menu::move(menu_index_t from, menu_index_t to) {
+    if (from >= _num_components || to >= _num_components || is_generated())
+        return false;
+
+    // The cursor follows its component
+    MenuComponent* p_component = _menu_components[from];
+    if (_current_component_num == from)
+        _current_component_num = to;
+    else if (from < to && _current_component_num > from
+             && _current_component_num <= to)
+        --_current_component_num;
+    else if (to < from && _current_component_num >= to
+             && _current_component_num < from)
+        ++_current_component_num;
+
+    if (from < to)
+        memmove(_menu_components + from, _menu_components + from + 1,
+                (to - from) * sizeof(MenuComponent*));
+    else
+        memmove(_menu_components + to + 1, _menu_components + to,
+                (from - to) * sizeof(MenuComponent*));
+    _menu_components[to] = p_component;
+
+    _previous_component_num = _current_component_num;
+    scroll_to_current();
+    return true;
+}
+
+void Menu::set_current_component(menu_index_t component_num, bool notify) {
+    if (component_num >= _num_components)
+        return;
+
+    _previous_component_num = _current_component_num;
+    get_component(_current_component_num)->set_current(false);
+
+    _current_component_num = component_num;
+    if (notify)
+        get_component(component_num)->set_current();
+    else
+        get_component(component_num)->_is_current = true;
+    scroll_to_current();
+}
+
+void Menu::set_visible_count(uint8_t visible_count) {
+    _visible_count = visible_count;
+    scroll_to_current();
+}
+
+void Menu::scroll_to_current() {
+    const menu_index_t num_visible = get_num_visible();
+    if (num_visible == 0)
+        _first_visible_num = 0;
+    else if (_current_component_num < _first_visible_num)
+        _first_visible_num = _current_component_num;
+    else if (_current_component_num >= _first_visible_num + num_visible)
+        _first_visible_num = _current_component_num - num_visible + 1;
+    else if (_first_visible_num + num_visible > _num_components)
+        _first_visible_num = _num_components - num_visible;
+}
+
+menu_index_t Menu::get_first_visible_num() const {
+    return _first_visible_num;
+}
+
+menu_index_t Menu::get_num_visible() const {
+    if (_visible_count == 0 || _visible_count > _num_components)
+        return _num_components;
+    return _visible_count;
+}
+
+MenuComponent const* Menu::get_visible_component(menu_index_t index) const {
+    return get_component(_first_visible_num + index);
+}
+
+MenuComponent const* Menu::get_menu_component(menu_index_t index) const {
+    return get_component(index);
 }
 
 MenuComponent const* Menu::get_current_component() const {
-    return _p_current_component;
+    return get_current();
+}
+
+MenuComponent* Menu::get_current() const {
+    return _num_components ? get_component(_current_component_num)
+                           : nullptr;
 }
 
-uint8_t Menu::get_num_components() const {
+MenuComponent* Menu::get_component(menu_index_t num) const {
+    return _menu_components[num];
+}
+
+menu_index_t Menu::get_component_num(MenuComponent const* p_component) const {
+    menu_index_t num = 0;
+    while (num < _num_components && _menu_components[num] != p_component)
+        ++num;
+    return num;
+}
+
+bool Menu::is_generated() const {
+    return false;
+}
+
+menu_index_t Menu::get_num_components() const {
     return _num_components;
 }
 
-uint8_t Menu::get_current_component_num() const {
+menu_index_t Menu::get_current_component_num() const {
     return _current_component_num;
 }
 
-uint8_t Menu::get_previous_component_num() const {
+menu_index_t Menu::get_previous_component_num() const {
     return _previous_component_num;
 }
 
 void Menu::render(MenuComponentRenderer const& renderer) const {
+    MENU_STATS(++menu_stats.num_renders[MENU_COMPONENT_MENU]);
     renderer.render(*this);
 }
 
+// *********************************************************
+// VirtualMenu
+// *********************************************************
+
+// Marks a pool slot that holds no entry; entry numbers stay below it.
+static const menu_index_t SLOT_EMPTY = MENU_INDEX_MAX;
+
+VirtualMenu::VirtualMenu(const char* name, CountFnPtr count_fn,
+                         GenerateFnPtr generate_fn,
+                         MenuComponent** pool, menu_index_t* slot_nums,
+                         uint8_t pool_size,
+                         ComponentCbPtr on_activate,
+                         ComponentCbPtr on_current)
+  : Menu(name, on_activate, on_current),
+  _count_fn(count_fn),
+  _generate_fn(generate_fn),
+  _pool(pool),
+  _pool_size(pool_size),
+  _slot_nums(slot_nums) {
+    // Without two slots the current entry and the one being rendered
+    // would share a component, so the menu stays empty
+    if (pool == nullptr || slot_nums == nullptr || pool_size < 2
+        || !can_be_parent())
+        _pool_size = 0;
+    for (uint8_t slot = 0; slot < _pool_size; ++slot)
+        _pool[slot]->set_parent(this);
+    refresh();
+}
+
+void VirtualMenu::refresh() {
+    for (uint8_t slot = 0; slot < _pool_size; ++slot)
+        _slot_nums[slot] = SLOT_EMPTY;
+
+    menu_index_t num_components = _pool_size ? _count_fn(*this) : 0;
+    if (num_components == SLOT_EMPTY)
+        --num_components;
+    _num_components = num_components;
+
+    if (_current_component_num >= _num_components)
+        _current_component_num = _num_components ? _num_components - 1 : 0;
+    if (_previous_component_num >= _num_components)
+        _previous_component_num = _current_component_num;
+    scroll_to_current();
+}
+
+menu_index_t VirtualMenu::get_component_num(
+  MenuComponent const* p_component) const {
+    for (uint8_t slot = 0; slot < _pool_size; ++slot) {
+        if (_pool[slot] == p_component && _slot_nums[slot] != SLOT_EMPTY)
+            return _slot_nums[slot];
+    }
+    return _num_components;
+}
+
+Menu* VirtualMenu::activate() {
+    refresh();
+    return Menu::activate();
+}
+
+MenuComponent* VirtualMenu::get_component(menu_index_t num) const {
+    const uint8_t slot = num % _pool_size;
+    MenuComponent* p_component = _pool[slot];
+    if (_slot_nums[slot] != num) {
+        _slot_nums[slot] = num;
+        p_component->_is_active = false;
+        p_component->_is_current = is_active() && num == _current_component_num;
+        _generate_fn(*this, num, *p_component);
+    }
+    return p_component;
+}
+
+bool VirtualMenu::is_generated() const {
+    return true;
+}
+
 // *********************************************************
 // BackMenuItem
 // *********************************************************
@@ -221,11 +730,11 @@ void Menu::render(MenuComponentRenderer const& renderer) const {
 BackMenuItem::BackMenuItem(const char* name, MenuSystem* ms, ComponentCbPtr on_activate, ComponentCbPtr on_current)
   : MenuItem(name, on_activate, on_current),
   _menu_system(ms) {
+    _kind = MENU_COMPONENT_BACK;
 }
 
 Menu* BackMenuItem::activate() {
-    if (_on_activate!=nullptr)
-        _on_activate(this);
+    call_on_activate();
 
     if (_menu_system!=nullptr)
         _menu_system->back();
@@ -234,6 +743,7 @@ Menu* BackMenuItem::activate() {
 }
 
 void BackMenuItem::render(MenuComponentRenderer const& renderer) const {
+    MENU_STATS(++menu_stats.num_renders[MENU_COMPONENT_BACK]);
     renderer.render(*this);
 }
 
@@ -256,6 +766,7 @@ void MenuItem::reset() {
 }
 
 void MenuItem::render(MenuComponentRenderer const& renderer) const {
+    MENU_STATS(++menu_stats.num_renders[MENU_COMPONENT_ITEM]);
     renderer.render(*this);
 }
 
@@ -282,7 +793,10 @@ NumericMenuItem::NumericMenuItem(
 				      _min_value(min_value),
 				      _max_value(max_value),
 				      _increment(increment),
-				      _format_value_fn(format_value_fn){
+				      _format_value_fn(format_value_fn),
+				      _format_fn(nullptr),
+				      _decimals(2){
+    _kind = MENU_COMPONENT_NUMERIC;
     if (_increment < 0.0) _increment = -_increment;
     if (_min_value > _max_value) {
         float tmp = _max_value;
@@ -296,17 +810,26 @@ void NumericMenuItem::set_number_formatter(
   _format_value_fn = format_value_fn;
 }
 
+void NumericMenuItem::set_value_formatter(FormatValueFnPtr format_fn) {
+    _format_fn = format_fn;
+}
+
+void NumericMenuItem::set_decimals(uint8_t decimals) {
+    _decimals = decimals;
+}
+
 Menu* NumericMenuItem::activate() {
     _is_active = !_is_active;
 
-    // Only run _on_activate when the user is done editing the value
-    if (!_is_active && _on_activate != nullptr)
-        _on_activate(this);
+    // Only run on_activate when the user is done editing the value
+    if (!_is_active)
+        call_on_activate();
     return nullptr;
 }
 
 void NumericMenuItem::render(
     MenuComponentRenderer const& renderer) const {
+    MENU_STATS(++menu_stats.num_renders[MENU_COMPONENT_NUMERIC]);
     renderer.render(*this);
 }
 
@@ -323,14 +846,32 @@ float NumericMenuItem::get_max_value() const {
 }
 
 string NumericMenuItem::get_formatted_value() const {
-    string buffer;
-    if (_format_value_fn != nullptr)
-        buffer += _format_value_fn(_value);
-    else
-        buffer += _value;
+    if (_format_fn == nullptr && _format_value_fn != nullptr)
+        return _format_value_fn(_value);
+
+    char buffer[24];
+    format_value(buffer, sizeof(buffer));
     return buffer;
 }
 
+size_t NumericMenuItem::format_value(char* buffer, size_t size) const {
+    if (_format_fn != nullptr)
+        return _format_fn(_value, buffer, size);
+
+    if (_format_value_fn != nullptr) {
+        if (size == 0)
+            return 0;
+        const string formatted = _format_value_fn(_value);
+        size_t length = formatted.size() < size - 1
+            ? formatted.size() : size - 1;
+        memcpy(buffer, formatted.data(), length);
+        buffer[length] = '\0';
+        return length;
+    }
+
+    return menu_format_fixed(_value, _decimals, buffer, size);
+}
+
 void NumericMenuItem::set_value(float value) {
     _value = value;
 }
@@ -365,6 +906,78 @@ bool NumericMenuItem::prev(bool loop) {
     return true;
 }
 
+// *********************************************************
+// SteppedMenuItem
+// *********************************************************
+
+SteppedMenuItem::SteppedMenuItem(
+   const char* name, uint16_t step_num, uint16_t num_steps,
+   ComponentCbPtr on_activate, ComponentCbPtr on_current)
+: MenuItem(name, on_activate, on_current),
+  _step_num(step_num > num_steps ? num_steps : step_num),
+  _num_steps(num_steps) {
+    _kind = MENU_COMPONENT_STEPPED;
+}
+
+uint16_t SteppedMenuItem::get_step_num() const {
+    return _step_num;
+}
+
+void SteppedMenuItem::set_step_num(uint16_t step_num) {
+    _step_num = step_num > _num_steps ? _num_steps : step_num;
+}
+
+uint16_t SteppedMenuItem::get_num_steps() const {
+    return _num_steps;
+}
+
+Menu* SteppedMenuItem::activate() {
+    _is_active = !_is_active;
+
+    // Only run on_activate when the user is done editing the value
+    if (!_is_active)
+        call_on_activate();
+    return nullptr;
+}
+
+void SteppedMenuItem::render(MenuComponentRenderer const& renderer) const {
+    MENU_STATS(++menu_stats.num_renders[MENU_COMPONENT_STEPPED]);
+    renderer.render(*this);
+}
+
+bool SteppedMenuItem::next(bool loop) {
+    if (_step_num < _num_steps)
+        ++_step_num;
+    else if (loop)
+        _step_num = 0;
+    return true;
+}
+
+bool SteppedMenuItem::prev(bool loop) {
+    if (_step_num > 0)
+        --_step_num;
+    else if (loop)
+        _step_num = _num_steps;
+    return true;
+}
+
+// *********************************************************
+// MenuComponentRenderer
+// *********************************************************
+
+void MenuComponentRenderer::render(Menu const& menu,
+                                   MenuChangeSet const&) const {
+    render(menu);
+}
+
+uint8_t MenuComponentRenderer::get_visible_count() const {
+    return 0;
+}
+
+void MenuComponentRenderer::render(SteppedMenuItem const& menu_item) const {
+    render(static_cast<MenuItem const&>(menu_item));
+}
+
 // *********************************************************
 // MenuSystem
 // *********************************************************
@@ -373,45 +986,137 @@ MenuSystem::MenuSystem(
   MenuComponentRenderer const& renderer, const char* name):
   _p_root_menu(new Menu(name, nullptr)),
   _p_current_menu(_p_root_menu),
-  _renderer(renderer) {
+  _p_renderer(&renderer),
+  _p_index(nullptr),
+  _index_size(0),
+  _changes(MENU_CHANGE_MENU),
+  _displayed_component_num(0),
+  _owns_root(true) {
   _p_root_menu->set_current(true);
   _p_root_menu->set_active(true);
 }
 
+MenuSystem::MenuSystem(const char* name):
+  _p_root_menu(new Menu(name, nullptr)),
+  _p_current_menu(_p_root_menu),
+  _p_renderer(nullptr),
+  _p_index(nullptr),
+  _index_size(0),
+  _changes(MENU_CHANGE_MENU),
+  _displayed_component_num(0),
+  _owns_root(true) {
+  _p_root_menu->set_current(true);
+  _p_root_menu->set_active(true);
+}
+
+MenuSystem::MenuSystem(Menu& root, MenuComponentRenderer const& renderer):
+  _p_root_menu(&root),
+  _p_current_menu(_p_root_menu),
+  _p_renderer(&renderer),
+  _p_index(nullptr),
+  _index_size(0),
+  _changes(MENU_CHANGE_MENU),
+  _displayed_component_num(0),
+  _owns_root(false) {
+  _p_root_menu->set_current(true);
+  _p_root_menu->set_active(true);
+}
+
+MenuSystem::MenuSystem(Menu& root):
+  _p_root_menu(&root),
+  _p_current_menu(_p_root_menu),
+  _p_renderer(nullptr),
+  _p_index(nullptr),
+  _index_size(0),
+  _changes(MENU_CHANGE_MENU),
+  _displayed_component_num(0),
+  _owns_root(false) {
+  _p_root_menu->set_current(true);
+  _p_root_menu->set_active(true);
+}
+
+MenuSystem::~MenuSystem() {
+  // An owned root was made with new Menu, so the delete is exact. A
+  // virtual destructor would grow every vtable, which AVR keeps in RAM.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdelete-non-virtual-dtor"
+  if (_owns_root)
+    delete _p_root_menu;
+#pragma GCC diagnostic pop
+}
+
 bool MenuSystem::next(bool loop) {
-    if (_p_current_menu->_p_current_component->is_active())
-        return _p_current_menu->_p_current_component->next(loop);
-    else
-        return _p_current_menu->next(loop);
+    MENU_STATS(++menu_stats.num_next);
+    MenuComponent* p_current = _p_current_menu->get_current();
+    if (p_current != nullptr && p_current->is_active()) {
+        if (!p_current->next(loop))
+            return false;
+        _changes |= MENU_CHANGE_VALUE;
+        return true;
+    }
+    const menu_index_t first_visible_num = _p_current_menu->_first_visible_num;
+    if (!_p_current_menu->next(loop))
+        return false;
+    _changes |= MENU_CHANGE_CURSOR;
+    if (_p_current_menu->_first_visible_num != first_visible_num)
+        _changes |= MENU_CHANGE_SCROLL;
+    return true;
 }
 
 bool MenuSystem::prev(bool loop) {
-    if (_p_current_menu->_p_current_component->is_active())
-        return _p_current_menu->_p_current_component->prev(loop);
-    else
-        return _p_current_menu->prev(loop);
+    MENU_STATS(++menu_stats.num_prev);
+    MenuComponent* p_current = _p_current_menu->get_current();
+    if (p_current != nullptr && p_current->is_active()) {
+        if (!p_current->prev(loop))
+            return false;
+        _changes |= MENU_CHANGE_VALUE;
+        return true;
+    }
+    const menu_index_t first_visible_num = _p_current_menu->_first_visible_num;
+    if (!_p_current_menu->prev(loop))
+        return false;
+    _changes |= MENU_CHANGE_CURSOR;
+    if (_p_current_menu->_first_visible_num != first_visible_num)
+        _changes |= MENU_CHANGE_SCROLL;
+    return true;
 }
 
 void MenuSystem::reset() {
-  // go to root menu
-  _p_current_menu->set_active(false);
-  _p_current_menu->reset();
-  _p_current_menu = _p_root_menu;
+  MENU_STATS(++menu_stats.num_reset);
+  // go to root menu, forgetting remembered positions on the way
+  while (_p_current_menu != _p_root_menu) {
+    _p_current_menu->set_active(false);
+    _p_current_menu->reset();
+    _p_current_menu = const_cast<Menu*>(_p_current_menu->get_parent());
+  }
   _p_root_menu->set_active(true);
   _p_root_menu->reset();
+  _changes |= MENU_CHANGE_MENU;
 }
 
 void MenuSystem::activate() {
+    MENU_STATS(++menu_stats.num_activate);
+    MenuComponent const* p_component = _p_current_menu->get_current();
+    const bool was_active = p_component != nullptr && p_component->is_active();
+
     Menu* pMenu = _p_current_menu->activate_menucomponent();
 
-    if (pMenu != nullptr)
+    if (pMenu != nullptr) {
         _p_current_menu = pMenu;
+        _changes |= MENU_CHANGE_MENU;
+    } else if (p_component != nullptr
+               && p_component->is_active() != was_active) {
+        _changes |= MENU_CHANGE_FOCUS;
+    }
 }
 
 bool MenuSystem::back() {
+  MENU_STATS(++menu_stats.num_back);
   // Deactivate current component if it has focus
-  if (_p_current_menu->_p_current_component->is_active()){
-    _p_current_menu->_p_current_component->set_active(false);
+  MenuComponent* p_current = _p_current_menu->get_current();
+  if (p_current != nullptr && p_current->is_active()){
+    p_current->set_active(false);
+    _changes |= MENU_CHANGE_FOCUS;
     return true;
   }
   // Go 1 level up if no component was active
@@ -419,10 +1124,11 @@ bool MenuSystem::back() {
   if (_p_current_menu != _p_root_menu){
     // reset the items in the current menu and deactivate it
     _p_current_menu->set_active(false);
-    _p_current_menu->reset();
+    _p_current_menu->leave();
     // activate the parent menu
     _p_current_menu = const_cast<Menu *>(_p_current_menu->get_parent());
     _p_current_menu->set_active(true);
+    _changes |= MENU_CHANGE_MENU;
     return true;
   }
 
@@ -430,6 +1136,339 @@ bool MenuSystem::back() {
   return false;
 }
 
+bool MenuSystem::back(uint8_t levels) {
+    bool changed = false;
+    for (; levels > 0 && back(); --levels)
+        changed = true;
+    return changed;
+}
+
+bool MenuSystem::back_to_root() {
+    bool changed = false;
+    while (back())
+        changed = true;
+    return changed;
+}
+
+bool MenuSystem::process(const MenuEvent* events, size_t num_events,
+                         bool loop) {
+    return process(events, num_events, nullptr, 0, loop);
+}
+
+// The i-th event of two runs taken as one
+static inline MenuEvent event_at(const MenuEvent* events, size_t num_events,
+                                 const MenuEvent* more_events, size_t i) {
+    return i < num_events ? events[i] : more_events[i - num_events];
+}
+
+bool MenuSystem::process(const MenuEvent* events, size_t num_events,
+                         const MenuEvent* more_events, size_t num_more_events,
+                         bool loop) {
+    const size_t num_total = num_events + num_more_events;
+    MENU_STATS(menu_stats.num_events += num_total);
+    size_t i = 0;
+    while (i < num_total) {
+        switch (event_at(events, num_events, more_events, i)) {
+        case MENU_EVENT_NEXT:
+        case MENU_EVENT_PREV:
+            i = process_moves(events, num_events, more_events,
+                              num_more_events, i, loop);
+            continue;
+        case MENU_EVENT_ACTIVATE:
+            activate();
+            break;
+        case MENU_EVENT_BACK:
+            back();
+            break;
+        case MENU_EVENT_RESET:
+            reset();
+            break;
+        }
+        ++i;
+    }
+
+    if (_changes == MENU_CHANGE_NONE)
+        return false;
+    display();
+    return true;
+}
+
+size_t MenuSystem::process_moves(const MenuEvent* events, size_t num_events,
+                                 const MenuEvent* more_events,
+                                 size_t num_more_events, size_t i,
+                                 bool loop) {
+    const size_t num_total = num_events + num_more_events;
+    MenuComponent* p_component = _p_current_menu->get_current();
+
+    // A focused component changes its own state; there are no callbacks
+    // to save, so just apply every event.
+    if (p_component != nullptr && p_component->is_active()) {
+        for (; i < num_total; ++i) {
+            const MenuEvent event =
+                event_at(events, num_events, more_events, i);
+            if (event == MENU_EVENT_NEXT)
+                next(loop);
+            else if (event == MENU_EVENT_PREV)
+                prev(loop);
+            else
+                break;
+        }
+        return i;
+    }
+
+    // Find where the run ends exactly as next/prev would, then move there
+    // once.
+    const menu_index_t num_components = _p_current_menu->_num_components;
+    const menu_index_t start = _p_current_menu->_current_component_num;
+    menu_index_t position = start;
+    for (; i < num_total; ++i) {
+        const MenuEvent event = event_at(events, num_events, more_events, i);
+        if (event == MENU_EVENT_NEXT) {
+            if (position + 1 < num_components)
+                ++position;
+            else if (loop)
+                position = 0;
+        } else if (event == MENU_EVENT_PREV) {
+            if (position > 0)
+                --position;
+            else if (loop && num_components)
+                position = num_components - 1;
+        } else {
+            break;
+        }
+    }
+
+    if (position != start) {
+        const menu_index_t first_visible_num = _p_current_menu->_first_visible_num;
+        _p_current_menu->set_current_component(position);
+        _changes |= MENU_CHANGE_CURSOR;
+        if (_p_current_menu->_first_visible_num != first_visible_num)
+            _changes |= MENU_CHANGE_SCROLL;
+    }
+    return i;
+}
+
+bool MenuSystem::jump_to_path(const menu_index_t* component_nums, uint8_t depth,
+                              bool notify) {
+    if (depth == 0 || depth > MENUSYSTEM_MAX_DEPTH)
+        return false;
+
+    // Check the whole path before changing anything
+    Menu* p_menu = _p_root_menu;
+    for (uint8_t level = 0; level < depth; ++level) {
+        if (component_nums[level] >= p_menu->_num_components)
+            return false;
+        MenuComponent* p_component =
+            p_menu->get_component(component_nums[level]);
+        if (level + 1 < depth) {
+            if (p_component->get_kind() != MENU_COMPONENT_MENU)
+                return false;
+            p_menu = static_cast<Menu*>(p_component);
+        }
+    }
+
+    // Leave the current menus as back() would, without callbacks
+    MenuComponent* p_current = _p_current_menu->get_current();
+    if (p_current != nullptr)
+        p_current->set_active(false);
+    while (_p_current_menu != _p_root_menu) {
+        _p_current_menu->set_active(false);
+        _p_current_menu->leave();
+        _p_current_menu = const_cast<Menu*>(_p_current_menu->get_parent());
+    }
+
+    // Enter the menus on the path
+    for (uint8_t level = 0; level + 1 < depth; ++level) {
+        _p_current_menu->set_current_component(component_nums[level], false);
+        _p_current_menu =
+            static_cast<Menu*>(_p_current_menu->get_current());
+        _p_current_menu->set_active(true);
+    }
+    _p_current_menu->set_current_component(component_nums[depth - 1], notify);
+
+    _changes |= MENU_CHANGE_MENU;
+    return true;
+}
+
+bool MenuSystem::jump_to(const char* path, bool notify) {
+    menu_index_t component_nums[MENUSYSTEM_MAX_DEPTH];
+    uint8_t depth = 0;
+    Menu const* p_menu = _p_root_menu;
+
+    while (*path != '\0') {
+        const char* end = strchr(path, '/');
+        const size_t length = end != nullptr ? end - path : strlen(path);
+
+        if (p_menu == nullptr || depth == MENUSYSTEM_MAX_DEPTH)
+            return false;
+
+        menu_index_t num = 0;
+        for (; num < p_menu->_num_components; ++num) {
+            const char* name = p_menu->get_component(num)->get_name();
+            if (strncmp(name, path, length) == 0 && name[length] == '\0')
+                break;
+        }
+        if (num == p_menu->_num_components)
+            return false;
+        component_nums[depth++] = num;
+
+        MenuComponent const* p_component = p_menu->get_component(num);
+        p_menu = p_component->get_kind() == MENU_COMPONENT_MENU
+            ? static_cast<Menu const*>(p_component) : nullptr;
+
+        path += length;
+        if (*path == '/')
+            ++path;
+    }
+
+    return jump_to_path(component_nums, depth, notify);
+}
+
+bool MenuSystem::jump_to(MenuComponent const* p_component, bool notify) {
+    menu_index_t component_nums[MENUSYSTEM_MAX_DEPTH];
+    uint8_t depth = 0;
+
+    // Walk up to the root, filling the path from the end
+    for (; p_component != _p_root_menu;
+         p_component = p_component->get_parent()) {
+        Menu const* p_parent = p_component->get_parent();
+        if (p_parent == nullptr || depth == MENUSYSTEM_MAX_DEPTH)
+            return false;
+
+        const menu_index_t num = p_parent->get_component_num(p_component);
+        if (num == p_parent->_num_components)
+            return false;
+        component_nums[MENUSYSTEM_MAX_DEPTH - 1 - depth++] = num;
+    }
+
+    return jump_to_path(component_nums + MENUSYSTEM_MAX_DEPTH - depth, depth,
+                        notify);
+}
+
+uint16_t MenuSystem::build_index(MenuIndexEntry* entries,
+                                 uint16_t max_entries) {
+    _p_index = nullptr;
+    _index_size = 0;
+    if (max_entries == 0)
+        return 0;
+
+    entries[0].component = _p_root_menu;
+    entries[0].parent_id = MENU_INDEX_NONE;
+    entries[0].component_num = 0;
+    entries[0].depth = 0;
+    uint16_t size = 1;
+
+    // Breadth-first walk using the index itself as the queue. Generated
+    // children only exist while they are on screen, so they're left out.
+    for (uint16_t id = 0; id < size; ++id) {
+        if (entries[id].component->get_kind() != MENU_COMPONENT_MENU)
+            continue;
+        Menu const* p_menu = static_cast<Menu const*>(entries[id].component);
+        if (p_menu->is_generated())
+            continue;
+        if (size + p_menu->_num_components > max_entries)
+            return 0;
+
+        for (menu_index_t num = 0; num < p_menu->_num_components; ++num) {
+            MenuIndexEntry& entry = entries[size++];
+            entry.component = p_menu->get_component(num);
+            entry.parent_id = id;
+            entry.component_num = num;
+            entry.depth = entries[id].depth + 1;
+        }
+    }
+
+    _p_index = entries;
+    _index_size = size;
+    return size;
+}
+
+bool MenuSystem::jump_to_id(uint16_t id, bool notify) {
+    if (id == 0 || id >= _index_size)
+        return false;
+
+    const uint8_t depth = _p_index[id].depth;
+    if (depth > MENUSYSTEM_MAX_DEPTH)
+        return false;
+
+    menu_index_t component_nums[MENUSYSTEM_MAX_DEPTH];
+    for (uint8_t level = depth; level > 0; --level) {
+        component_nums[level - 1] = _p_index[id].component_num;
+        id = _p_index[id].parent_id;
+    }
+    return jump_to_path(component_nums, depth, notify);
+}
+
+// The first byte of a saved state holds the depth and this flag
+static const uint8_t STATE_FOCUSED = 0x80;
+
+static_assert(MENUSYSTEM_MAX_DEPTH < STATE_FOCUSED
+              && MENUSYSTEM_STATE_SIZE <= UINT8_MAX,
+              "MENUSYSTEM_MAX_DEPTH is too large for save_state");
+
+uint8_t MenuSystem::save_state(uint8_t* buffer, uint8_t size) const {
+    Menu const* p_menu = _p_current_menu;
+    bool is_focused = false;
+    if (p_menu->_num_components == 0) {
+        if (p_menu == _p_root_menu)
+            return 0;
+        p_menu = p_menu->get_parent();
+    } else {
+        is_focused = p_menu->get_current()->is_active();
+    }
+
+    uint8_t depth = 1;
+    for (Menu const* p = p_menu; p != _p_root_menu; p = p->get_parent())
+        ++depth;
+    const uint8_t state_size = 1 + depth * sizeof(menu_index_t);
+    if (depth > MENUSYSTEM_MAX_DEPTH || state_size > size)
+        return 0;
+
+    // Each menu above the current one has the menu below it as its current
+    // component, so the path is read walking up, filling it from the end
+    buffer[0] = depth | (is_focused ? STATE_FOCUSED : 0);
+    for (uint8_t level = depth; level > 0; p_menu = p_menu->get_parent()) {
+        const menu_index_t num = p_menu->_current_component_num;
+        uint8_t* p_bytes = buffer + 1 + --level * sizeof(menu_index_t);
+        for (uint8_t i = 0; i < sizeof(menu_index_t); ++i)
+            p_bytes[i] = uint8_t(num >> (8 * i));
+    }
+    return state_size;
+}
+
+bool MenuSystem::restore_state(const uint8_t* buffer, uint8_t size,
+                               bool notify) {
+    if (size == 0)
+        return false;
+    const uint8_t depth = buffer[0] & ~STATE_FOCUSED;
+    if (depth == 0 || depth > MENUSYSTEM_MAX_DEPTH
+        || 1 + depth * sizeof(menu_index_t) > size)
+        return false;
+
+    menu_index_t component_nums[MENUSYSTEM_MAX_DEPTH];
+    for (uint8_t level = 0; level < depth; ++level) {
+        const uint8_t* p_bytes = buffer + 1 + level * sizeof(menu_index_t);
+        menu_index_t num = 0;
+        for (uint8_t i = 0; i < sizeof(menu_index_t); ++i)
+            num |= menu_index_t(p_bytes[i]) << (8 * i);
+        component_nums[level] = num;
+    }
+    if (!jump_to_path(component_nums, depth, notify))
+        return false;
+
+    // Only values can be edited; a focused plain item would swallow
+    // next and prev
+    MenuComponent* p_current = _p_current_menu->get_current();
+    const MenuComponentKind kind = p_current->get_kind();
+    if ((buffer[0] & STATE_FOCUSED)
+        && (kind == MENU_COMPONENT_NUMERIC
+            || kind == MENU_COMPONENT_STEPPED)) {
+        p_current->set_active(true);
+        _changes |= MENU_CHANGE_FOCUS;
+    }
+    return true;
+}
+
 Menu& MenuSystem::get_root_menu() const {
     return *_p_root_menu;
 }
@@ -438,11 +1477,44 @@ Menu const* MenuSystem::get_current_menu() const {
     return _p_current_menu;
 }
 
+void MenuSystem::invalidate() {
+    _changes |= MENU_CHANGE_MENU;
+}
+
+uint8_t MenuSystem::get_changes() const {
+    return _changes;
+}
+
 void MenuSystem::display() const {
-  if (_p_current_menu != nullptr){
-    _renderer.render(*_p_current_menu);
-  }
-  else{
-    _renderer.render(*_p_root_menu);
+  if (_p_renderer == nullptr)
+    return;
+
+  MenuChangeSet changes;
+  Menu const& menu = begin_display(_p_renderer->get_visible_count(), changes);
+  MENU_STATS(++menu_stats.num_display);
+  MENU_STATS(const uint32_t start = menu_stats_now());
+  _p_renderer->render(menu, changes);
+  MENU_STATS(menu_stats_add_render_time(start));
+  end_display(changes);
+}
+
+Menu const& MenuSystem::begin_display(uint8_t visible_count,
+                                      MenuChangeSet& changes) const {
+  Menu* p_menu =
+    _p_current_menu != nullptr ? _p_current_menu : _p_root_menu;
+
+  if (p_menu->_visible_count != visible_count) {
+    p_menu->set_visible_count(visible_count);
+    _changes |= MENU_CHANGE_MENU;
   }
+
+  changes.changes = _changes;
+  changes.previous_component_num = _displayed_component_num;
+  changes.current_component_num = p_menu->get_current_component_num();
+  return *p_menu;
+}
+
+void MenuSystem::end_display(MenuChangeSet const& changes) const {
+  _changes = MENU_CHANGE_NONE;
+  _displayed_component_num = changes.current_component_num;
 }
@@ -6,13 +6,143 @@
 #ifndef MENUSYSTEM_H
 #define MENUSYSTEM_H
 
+#include <stddef.h>
+#include <stdint.h>
 #include <string> 
 using namespace std;
 
+#include "MenuFormat.h"
+
+//! \brief Define MENUSYSTEM_COMPACT to trade pointers for byte indices
+//!
+//! In the compact layout a MenuComponent keeps its flags in a bitfield, its
+//! parent as an index into a table of all live Menu instances and its
+//! callbacks as indices into a table shared by all components. Every
+//! translation unit must be built with the same setting.
+//!
+//! A tree with more live menus or distinct callbacks than the tables hold
+//! needs MENUSYSTEM_MAX_MENUS or MENUSYSTEM_MAX_CALLBACKS raised. Past the
+//! limit, Menu::add and Menu::insert fail on the menus that didn't fit,
+//! callbacks that didn't fit are dropped, and
+//! menu_compact_has_overflowed() returns true.
+#ifdef MENUSYSTEM_COMPACT
+//! \brief Size of the menu table, slot 0 included
+#ifndef MENUSYSTEM_MAX_MENUS
+#define MENUSYSTEM_MAX_MENUS 16
+#endif
+//! \brief Size of the callback table, slot 0 included; a callback is
+//! stored once however many components use it
+#ifndef MENUSYSTEM_MAX_CALLBACKS
+#define MENUSYSTEM_MAX_CALLBACKS 16
+#endif
+static_assert(MENUSYSTEM_MAX_MENUS >= 2 && MENUSYSTEM_MAX_MENUS <= 256,
+              "MENUSYSTEM_MAX_MENUS must be between 2 and 256");
+static_assert(MENUSYSTEM_MAX_CALLBACKS >= 1
+              && MENUSYSTEM_MAX_CALLBACKS <= 256,
+              "MENUSYSTEM_MAX_CALLBACKS must be between 1 and 256");
+
+//! \brief Returns true if a menu or a callback didn't fit its table since
+//! start-up
+//!
+//! Check it once the tree is built, e.g. in setup().
+bool menu_compact_has_overflowed();
+#endif
+
+//! \brief The unsigned type numbering the components of a Menu
+//!
+//! A Menu holds at most MENU_INDEX_MAX components. Define it as uint16_t or
+//! uint32_t for longer menus; every translation unit must use the same
+//! type.
+#ifndef MENUSYSTEM_INDEX_TYPE
+#define MENUSYSTEM_INDEX_TYPE uint8_t
+#endif
+typedef MENUSYSTEM_INDEX_TYPE menu_index_t;
+static_assert(menu_index_t(-1) > menu_index_t(0),
+              "MENUSYSTEM_INDEX_TYPE must be unsigned");
+static const menu_index_t MENU_INDEX_MAX = menu_index_t(-1);
+
 class Menu;
 class MenuComponentRenderer;
 class MenuSystem;
 
+//! \brief The concrete type of a MenuComponent
+//!
+//! Used to render components without virtual calls; see
+//! menu_static_render.
+enum MenuComponentKind : uint8_t {
+    MENU_COMPONENT_ITEM,
+    MENU_COMPONENT_BACK,
+    MENU_COMPONENT_NUMERIC,
+    MENU_COMPONENT_STEPPED,
+    MENU_COMPONENT_MENU
+};
+
+//! \brief Define MENUSYSTEM_STATS to count and time the menu operations
+//!
+//! The counters are shared by every MenuSystem, since callbacks and
+//! component renders don't know which one they belong to. Without
+//! MENUSYSTEM_STATS none of this exists and the library is built exactly
+//! as before. Every translation unit must be built with the same setting.
+#ifdef MENUSYSTEM_STATS
+//! \brief Returns the current time, in any unit, e.g. micros on Arduino
+using MenuStatsClockFnPtr = uint32_t (*)();
+
+//! \brief Prints text, e.g. with Serial.print
+using MenuStatsPrintFnPtr = void (*)(const char* text);
+
+//! \brief Counts and timings collected with MENUSYSTEM_STATS
+//!
+//! Times are in the unit of the clock set with menu_stats_set_clock and
+//! stay 0 without one.
+struct MenuStats {
+    //! MenuSystem calls; next and prev don't include the moves
+    //! MenuSystem::process coalesces, which count as events
+    uint32_t num_next;
+    uint32_t num_prev;
+    uint32_t num_activate;
+    uint32_t num_back;
+    uint32_t num_reset;
+    uint32_t num_events;
+    uint32_t num_display;
+    //! Callbacks fired
+    uint32_t num_on_activate;
+    uint32_t num_on_current;
+    //! Component render calls, indexed by MenuComponentKind
+    uint32_t num_renders[MENU_COMPONENT_MENU + 1];
+    //! Time spent in the renderer, per display
+    uint32_t render_time;
+    uint32_t render_time_max;
+    //! Time spent in callbacks, per callback
+    uint32_t callback_time;
+    uint32_t callback_time_max;
+};
+
+extern MenuStats menu_stats;
+
+//! \brief Sets the clock timing the renderer and the callbacks, nullptr to
+//! only count
+void menu_stats_set_clock(MenuStatsClockFnPtr clock_fn);
+
+//! \brief Sets every counter and time to 0
+void menu_stats_clear();
+
+//! \brief Prints menu_stats, one `name value` line each
+void menu_stats_dump(MenuStatsPrintFnPtr print_fn);
+
+//! \brief Returns the time of the clock, 0 without one
+uint32_t menu_stats_now();
+
+//! \brief Adds the time since `start` to the render time
+void menu_stats_add_render_time(uint32_t start);
+
+//! \brief Adds the time since `start` to the callback time
+void menu_stats_add_callback_time(uint32_t start);
+
+#define MENU_STATS(statement) statement
+#else
+#define MENU_STATS(statement)
+#endif
+
 //! \brief Abstract base class that represents a component in the menu
 //! This is the abstract base class for the main components used
 //! to build a
@@ -31,6 +161,7 @@ class MenuSystem;
 class MenuComponent {
     friend class MenuSystem;
     friend class Menu;
+    friend class VirtualMenu;
 public:
     //! \brief Callback for when the MenuComponent is activated
     //!
@@ -52,6 +183,14 @@ public:
     //! \returns The component's name.
     const char* get_name() const;
 
+    //! \brief Gets the component's type tag
+    //!
+    //! Subclasses of the library components keep the tag of their base
+    //! class.
+    //!
+    //! \returns The MenuComponentKind of the component.
+    MenuComponentKind get_kind() const;
+
     //! \brief Renders the component using the given MenuComponentRenderer
     //!
     //! This is the `accept` method in the visitor design pattern.
@@ -117,7 +256,7 @@ public:
     void set_parent(Menu* p_parent);
 
     //! Returns pointer to the parent
-     Menu const* get_parent();
+    Menu const* get_parent() const;
 
 protected:
     //! \brief Processes the next action
@@ -204,13 +343,29 @@ protected:
     //! \see is_current
     void set_active(bool is_active=true);
 
+    //! \brief Calls the on_activate callback if there is one
+    void call_on_activate();
+
+    //! \brief Calls the on_current callback if there is one
+    void call_on_current();
+
 protected:
     const char* _name;
+#ifdef MENUSYSTEM_COMPACT
+    uint8_t _kind : 3;
+    bool _is_active : 1;
+    bool _is_current : 1;
+    uint8_t _on_activate_num;
+    uint8_t _on_current_num;
+    uint8_t _parent_num;
+#else
+    uint8_t _kind;
     bool _is_active;
     bool _is_current;
     ComponentCbPtr _on_activate;
     ComponentCbPtr _on_current;
     Menu* _p_parent;
+#endif
 };
 
 
@@ -280,6 +435,16 @@ public:
     //! \returns The string representation of value.
   using ValueCbPtr = const string (*)(const float value);
 
+    //! \brief Callback for formatting the numeric value into a caller
+    //! supplied buffer without allocating.
+    //!
+    //! \param value The value to convert.
+    //! \param buffer The buffer receiving the zero terminated text.
+    //! \param size The size of buffer in bytes, terminator included.
+    //! \returns The number of characters written, terminator excluded.
+  using FormatValueFnPtr = size_t (*)(const float value, char* buffer,
+                                      size_t size);
+
 public:
     //! Constructor
     //!
@@ -308,6 +473,22 @@ public:
     //!
     void set_number_formatter(ValueCbPtr format_value_fn);
 
+    //!
+    //! \brief Sets the allocation free number formatter.
+    //!
+    //! It takes precedence over the formatter set with
+    //! set_number_formatter. If nullptr the built-in fixed decimals
+    //! formatter is used.
+    //!
+    void set_value_formatter(FormatValueFnPtr format_fn);
+
+    //!
+    //! \brief Sets the number of decimals of the built-in formatter.
+    //!
+    //! \param decimals The number of decimals (2 by default, at most 6).
+    //!
+    void set_decimals(uint8_t decimals);
+
     float get_value() const;
     float get_min_value() const;
     float get_max_value() const;
@@ -318,6 +499,16 @@ public:
 
     string get_formatted_value() const;
 
+    //! \brief Writes the formatted value into a caller supplied buffer
+    //!
+    //! Doesn't allocate unless a string formatter set with
+    //! set_number_formatter is in use.
+    //!
+    //! \param[out] buffer The buffer receiving the zero terminated text.
+    //! \param[in] size The size of buffer in bytes, terminator included.
+    //! \returns The number of characters written, terminator excluded.
+    size_t format_value(char* buffer, size_t size) const;
+
     virtual void render(MenuComponentRenderer const& renderer) const;
 
 protected:
@@ -332,9 +523,235 @@ protected:
     float _max_value;
     float _increment;
     ValueCbPtr _format_value_fn;
+    FormatValueFnPtr _format_fn;
+    uint8_t _decimals;
 };
 
 
+//! \brief A fixed-point number `raw / Scale` for BasicNumericMenuItem
+//!
+//! Scale is usually a power of two (Q-format, see MenuQ8_8 and MenuQ16_16)
+//! or a power of ten, which represents decimal steps such as 0.1 exactly.
+//! Only integer arithmetic is used, so no soft-float code is pulled in.
+//! Rep is at most 32 bits wide.
+template <typename Rep, uint32_t Scale>
+struct MenuFixed {
+    Rep raw;
+
+    //! \brief Returns the fixed-point number closest to num / den,
+    //! saturated to the range of Rep
+    static constexpr MenuFixed ratio(int32_t num, int32_t den=1) {
+        return MenuFixed{saturate((int64_t(num) * Scale
+                                   + (num < 0 ? -den / 2 : den / 2)) / den)};
+    }
+
+private:
+    static constexpr int64_t rep_min() {
+        return Rep(-1) < Rep(0) ? -(int64_t(1) << (8 * sizeof(Rep) - 1)) : 0;
+    }
+
+    static constexpr int64_t rep_max() {
+        return (int64_t(1) << (8 * sizeof(Rep) - (Rep(-1) < Rep(0)))) - 1;
+    }
+
+    static constexpr Rep saturate(int64_t raw) {
+        return Rep(raw < rep_min() ? rep_min()
+                   : raw > rep_max() ? rep_max() : raw);
+    }
+};
+
+//! \brief Signed Q8.8 fixed-point number
+using MenuQ8_8 = MenuFixed<int16_t, 256>;
+
+//! \brief Signed Q16.16 fixed-point number
+using MenuQ16_16 = MenuFixed<int32_t, 65536>;
+
+//! \brief Conversions used by BasicNumericMenuItem for integral types
+template <typename T>
+struct MenuValueTraits {
+    static int32_t to_raw(T value) { return value; }
+    static T from_raw(int32_t raw) { return T(raw); }
+    static size_t format(T value, char* buffer, size_t size) {
+        return menu_format_int(value, buffer, size);
+    }
+};
+
+//! \brief Conversions used by BasicNumericMenuItem for MenuFixed
+template <typename Rep, uint32_t Scale>
+struct MenuValueTraits<MenuFixed<Rep, Scale> > {
+    static int32_t to_raw(MenuFixed<Rep, Scale> value) { return value.raw; }
+    static MenuFixed<Rep, Scale> from_raw(int32_t raw) {
+        return MenuFixed<Rep, Scale>{Rep(raw)};
+    }
+    static size_t format(MenuFixed<Rep, Scale> value,
+                         char* buffer, size_t size) {
+        // Enough decimals to tell neighbouring raw values apart
+        const uint8_t decimals = Scale <= 1 ? 0 : Scale <= 10 ? 1
+            : Scale <= 100 ? 2 : Scale <= 1000 ? 3 : Scale <= 10000 ? 4 : 5;
+        return menu_format_scaled(value.raw, Scale, decimals, buffer, size);
+    }
+};
+
+
+//! \brief A numeric MenuItem whose value is selected by a step number
+//!
+//! The value of a SteppedMenuItem is `min + step_num * increment`, with
+//! step_num in [0, num_steps]. next and prev only change step_num, so
+//! stepping is exact, never drifts and clamps or wraps exactly at the
+//! ends of the range. Subclasses map the step number to a value; see
+//! BasicNumericMenuItem.
+//!
+//! \see BasicNumericMenuItem
+//! \see NumericMenuItem
+class SteppedMenuItem : public MenuItem {
+public:
+    //! \brief Returns the current step number
+    uint16_t get_step_num() const;
+
+    //! \brief Sets the current step number, clamped to num_steps
+    void set_step_num(uint16_t step_num);
+
+    //! \brief Returns the step number of the maximum value
+    uint16_t get_num_steps() const;
+
+    //! \brief Writes the formatted value into a caller supplied buffer
+    //!
+    //! \see NumericMenuItem::format_value
+    virtual size_t format_value(char* buffer, size_t size) const = 0;
+
+    //! \copydoc MenuComponent::render
+    virtual void render(MenuComponentRenderer const& renderer) const;
+
+protected:
+    SteppedMenuItem(const char* name, uint16_t step_num, uint16_t num_steps,
+                    ComponentCbPtr on_activate, ComponentCbPtr on_current);
+
+    virtual bool next(bool loop=false);
+    virtual bool prev(bool loop=false);
+
+    virtual Menu* activate();
+
+protected:
+    uint16_t _step_num;
+    uint16_t _num_steps;
+};
+
+
+//! \brief A NumericMenuItem for integral and fixed-point values
+//!
+//! T is an integral type (int8_t, int16_t, int32_t, ...) or a MenuFixed.
+//! Unlike NumericMenuItem no float arithmetic is involved: the value is
+//! computed from the step number and formatted with integer arithmetic.
+//!
+//! If max_value isn't reached by a whole number of increments from
+//! min_value, the range ends at the last step below it. A range holds at
+//! most 65535 steps. Values must fit int32_t; the range may span all of it.
+//!
+//! \code
+//! Int16MenuItem volume("Volume", 50, 0, 100, 5);
+//! BasicNumericMenuItem<MenuQ8_8> gain("Gain", MenuQ8_8::ratio(1),
+//!     MenuQ8_8::ratio(0), MenuQ8_8::ratio(4), MenuQ8_8::ratio(1, 4));
+//! \endcode
+//!
+//! \see SteppedMenuItem
+template <typename T>
+class BasicNumericMenuItem : public SteppedMenuItem {
+public:
+    //! \brief Callback for formatting the value into a caller supplied
+    //! buffer.
+    using FormatValueFnPtr = size_t (*)(const T value, char* buffer,
+                                        size_t size);
+
+    //! Constructor
+    //!
+    //! @param name The name of the menu item.
+    //! @param value Default value.
+    //! @param min_value The minimum value.
+    //! @param max_value The maximum value.
+    //! @param increment How much the value should be incremented by.
+    //! @param on_activate The function to call when this
+    //! MenuItem is activated.
+    //! @param on_current The function to call when this MenuItem becomes
+    //! current.
+    //! @param format_fn The custom formatter. If nullptr the value is
+    //!                  printed as a decimal number.
+    BasicNumericMenuItem(const char* name,
+                         T value, T min_value, T max_value,
+                         T increment=MenuValueTraits<T>::from_raw(1),
+                         ComponentCbPtr on_activate=nullptr,
+                         ComponentCbPtr on_current=nullptr,
+                         FormatValueFnPtr format_fn=nullptr)
+    : SteppedMenuItem(name, 0,
+                      steps(min_value, max_value, increment),
+                      on_activate, on_current),
+      _min_value(min_value),
+      _increment(increment),
+      _format_fn(format_fn) {
+        set_value(value);
+    }
+
+    T get_value() const {
+        return value_at(_step_num);
+    }
+
+    T get_min_value() const {
+        return _min_value;
+    }
+
+    T get_max_value() const {
+        return value_at(_num_steps);
+    }
+
+    //! \brief Sets the value, rounded down to a step and clamped to the
+    //! range
+    void set_value(T value) {
+        set_step_num(steps(_min_value, value, _increment));
+    }
+
+    void set_value_formatter(FormatValueFnPtr format_fn) {
+        _format_fn = format_fn;
+    }
+
+    virtual size_t format_value(char* buffer, size_t size) const {
+        if (_format_fn != nullptr)
+            return _format_fn(get_value(), buffer, size);
+        return MenuValueTraits<T>::format(get_value(), buffer, size);
+    }
+
+private:
+    // Raw values are added and subtracted as uint32_t, which can't
+    // overflow: a range from INT32_MIN to INT32_MAX is 2^32 - 1 apart.
+    T value_at(uint16_t step_num) const {
+        // The sum lies between _min_value and the maximum, so it fits
+        return MenuValueTraits<T>::from_raw(int32_t(
+            uint32_t(MenuValueTraits<T>::to_raw(_min_value))
+            + step_num * uint32_t(MenuValueTraits<T>::to_raw(_increment))));
+    }
+
+    //! Returns the number of whole increments from `from` to `to`, 0 if
+    //! `to` is below `from`, clamped to 65535
+    static uint16_t steps(T from, T to, T increment) {
+        const int32_t raw_from = MenuValueTraits<T>::to_raw(from);
+        const int32_t raw_to = MenuValueTraits<T>::to_raw(to);
+        const int32_t raw_increment = MenuValueTraits<T>::to_raw(increment);
+        if (raw_to <= raw_from || raw_increment <= 0)
+            return 0;
+        const uint32_t num_steps =
+            (uint32_t(raw_to) - uint32_t(raw_from)) / uint32_t(raw_increment);
+        return num_steps > UINT16_MAX ? UINT16_MAX : uint16_t(num_steps);
+    }
+
+private:
+    T _min_value;
+    T _increment;
+    FormatValueFnPtr _format_fn;
+};
+
+using Int8MenuItem = BasicNumericMenuItem<int8_t>;
+using Int16MenuItem = BasicNumericMenuItem<int16_t>;
+using Int32MenuItem = BasicNumericMenuItem<int32_t>;
+
+
 //! \brief A MenuComponent that can contain other MenuComponents.
 //!
 //! Menu represents the branch in the composite design pattern (see:
@@ -345,18 +762,137 @@ protected:
 //! \see MenuItem
 class Menu : public MenuComponent {
     friend class MenuSystem;
+    friend class MenuComponent;
 public:
   Menu(const char* name, ComponentCbPtr on_activate=nullptr, ComponentCbPtr on_current=nullptr);
+    ~Menu();
+
+    //! A copy would free the same child list twice
+    Menu(Menu const&) = delete;
+    Menu& operator=(Menu const&) = delete;
 
     //! \brief Adds a MenuItem to the Menu
-    void add(MenuComponent* p_item);
+    //!
+    //! The child list grows geometrically, so adding N components costs
+    //! O(log N) reallocations. Use Menu::reserve when the final size is
+    //! known to allocate exactly once.
+    //!
+    //! The first component added to a displayed menu becomes current,
+    //! without calling its on_current callback.
+    //!
+    //! \returns true if the component was added, false if `p_item` is
+    //!          null, the menu is generated, the menu already holds
+    //!          MENU_INDEX_MAX components, the allocation failed or, with
+    //!          MENUSYSTEM_COMPACT, the menu didn't fit the menu table.
+    bool add(MenuComponent* p_item);
+
+    //! \brief Allocates room for at least `capacity` components
+    //!
+    //! \param[in] capacity The number of components the menu will hold.
+    //! \returns true if the menu can hold `capacity` components, false if
+    //!          the allocation failed or the menu uses external storage
+    //!          that is too small.
+    bool reserve(menu_index_t capacity);
+
+    //! \brief Stores the child list in `p_storage` instead of the heap
+    //!
+    //! The components added so far are moved there. The menu never grows
+    //! past `capacity` and never frees `p_storage`, which must outlive it.
+    //!
+    //! \returns false, leaving the menu untouched, if `capacity` is less
+    //!          than get_num_components().
+    //!
+    //! \see MenuArena::make_menu
+    bool set_storage(MenuComponent** p_storage, menu_index_t capacity);
+
+    //! \brief Inserts a component before the one at `num`
+    //!
+    //! The cursor stays on the same component; the first component
+    //! inserted into a displayed menu becomes current, without calling its
+    //! on_current callback. Call MenuSystem::invalidate when the menu is
+    //! displayed, and rebuild an index built with MenuSystem::build_index.
+    //!
+    //! \param[in] num Where to insert, up to get_num_components() to add
+    //!                at the end.
+    //! \returns false if `num` is out of range, `p_component` is null,
+    //!          the menu is generated or full, the allocation failed or,
+    //!          with MENUSYSTEM_COMPACT, the menu didn't fit the menu table.
+    bool insert(menu_index_t num, MenuComponent* p_component);
+
+    //! \brief Removes the component at `num`
+    //!
+    //! The cursor stays on the same component; if that's the removed one,
+    //! it moves to the next component, or the previous one at the end of
+    //! the menu, without calling its on_current callback. The removed
+    //! component loses its parent and focus. The child list never shrinks.
+    //!
+    //! \returns false if `num` is out of range, the menu is generated, or
+    //!          the component is the menu the user is in or one above it;
+    //!          go back out of it first.
+    bool remove_at(menu_index_t num);
+
+    //! \brief Removes `p_component` from the menu
+    //!
+    //! \see remove_at
+    bool remove(MenuComponent* p_component);
+
+    //! \brief Moves the component at `from` to `to`, shifting the ones in
+    //! between
+    //!
+    //! The cursor stays on the same component.
+    //!
+    //! \returns false if either number is out of range or the menu is
+    //!          generated.
+    bool move(menu_index_t from, menu_index_t to);
 
     MenuComponent const* get_current_component() const;
-    MenuComponent const* get_menu_component(uint8_t index) const;
+    MenuComponent const* get_menu_component(menu_index_t index) const;
+
+    menu_index_t get_num_components() const;
+    menu_index_t get_current_component_num() const;
 
-    uint8_t get_num_components() const;
-    uint8_t get_current_component_num() const;
-    uint8_t get_previous_component_num() const;
+    //! \brief Returns the number of `p_component` in the menu, or
+    //! get_num_components() if it isn't a child of the menu
+    virtual menu_index_t get_component_num(MenuComponent const* p_component) const;
+    menu_index_t get_previous_component_num() const;
+
+    //! \brief Returns true if the children are produced on demand and
+    //! only exist while they are used
+    virtual bool is_generated() const;
+
+
+    //! \brief Makes the menu keep its cursor and scroll window when the
+    //! user goes back out of it
+    //!
+    //! By default leaving a menu resets it, so entering it again starts at
+    //! its first component. A menu remembering its position is entered on
+    //! the component it was left on, with the same scroll window.
+    //! MenuSystem::reset still resets the menus it goes back through.
+    void set_remember_position(bool remember=true);
+    bool remembers_position() const;
+
+    //! \brief Sets the height of the scroll window
+    //!
+    //! The window is the range of components a renderer shows. It follows
+    //! the current component as the menu is navigated, scrolling by the
+    //! minimum amount needed to keep it visible. MenuSystem::display sets
+    //! it from MenuComponentRenderer::get_visible_count.
+    //!
+    //! \param[in] visible_count The number of components shown at once,
+    //!                          or 0 to show all of them.
+    void set_visible_count(uint8_t visible_count);
+
+    //! \brief Returns the number of the first component in the window
+    menu_index_t get_first_visible_num() const;
+
+    //! \brief Returns the number of components in the window
+    menu_index_t get_num_visible() const;
+
+    //! \brief Returns the component at `index` within the window
+    //!
+    //! \param[in] index 0 for the first visible component, up to
+    //!                  get_num_visible() - 1.
+    MenuComponent const* get_visible_component(menu_index_t index) const;
 
     //! \copydoc MenuComponent::render
     void render(MenuComponentRenderer const& renderer) const;
@@ -382,45 +918,518 @@ protected:
     //! \copydoc MenuComponent::reset
     virtual void reset();
 
+    //! \brief Called when the user goes back out of the menu
+    //!
+    //! Resets the menu unless it remembers its position, in which case
+    //! only the flags of its current component are cleared.
+    void leave();
+
     //void add_component(MenuComponent* p_component);
 
-private:
-    MenuComponent* _p_current_component;
+    //! \brief Makes the component at `component_num` current
+    //!
+    //! Unlike a series of next/prev calls, only the new current component
+    //! is notified.
+    //!
+    //! \param[in] component_num The number of the new current component.
+    //! \param[in] notify If true the new component's on_current callback
+    //!                   is called.
+    void set_current_component(menu_index_t component_num, bool notify=true);
+
+    //! \brief Scrolls the window so the current component is visible
+    void scroll_to_current();
+
+    //! \brief Makes room for one more component, growing the list
+    //! geometrically
+    bool grow();
+
+    //! \brief Returns false if children couldn't find their way back to
+    //! the menu, i.e. it didn't fit the MENUSYSTEM_COMPACT menu table
+    bool can_be_parent() const;
+
+    //! \brief Returns the current component, or nullptr if the menu is
+    //! empty
+    MenuComponent* get_current() const;
+
+    //! \brief Returns the component at `num`
+    //!
+    //! Every child is reached through this method, so subclasses can
+    //! produce children on demand.
+    //!
+    //! \see VirtualMenu
+    virtual MenuComponent* get_component(menu_index_t num) const;
+
+protected:
     MenuComponent** _menu_components;
-    uint8_t _num_components;
-    uint8_t _current_component_num;
-    uint8_t _previous_component_num;
+    menu_index_t _num_components;
+    menu_index_t _capacity;
+    menu_index_t _current_component_num;
+    menu_index_t _previous_component_num;
+    uint8_t _visible_count;
+    menu_index_t _first_visible_num;
+#ifdef MENUSYSTEM_COMPACT
+    bool _remembers_position : 1;
+    //! True if _menu_components was set with set_storage
+    bool _has_external_storage : 1;
+    uint8_t _menu_num;
+#else
+    bool _remembers_position;
+    //! True if _menu_components was set with set_storage
+    bool _has_external_storage;
+#endif
+};
+
+
+//! \brief A Menu whose children are produced on demand
+//!
+//! Listing files, presets or channels with a plain Menu takes one object per
+//! entry. A VirtualMenu asks a callback for the number of entries and has
+//! another callback turn a reusable component from a small pool into the
+//! entry at a given number, when that entry is shown or navigated to.
+//! Entry `num` always lives in pool slot `num % pool_size`, so each step
+//! and each rendered line costs at most one call to the generator,
+//! however long the list is.
+//!
+//! The pool must hold at least two components and at least as many as the
+//! renderer shows at once; a smaller or missing pool leaves the menu empty.
+//! The caller also supplies the array recording which entry each slot
+//! holds, so a VirtualMenu allocates nothing. Generated components are
+//! leaves: their state is lost when their slot is reused, so the generator
+//! must set everything the renderer and the callbacks need, usually from
+//! the caller's own storage. Menu::add and insert refuse components.
+//!
+//! \see Menu
+class VirtualMenu : public Menu {
+public:
+    //! \brief Callback returning the number of entries
+    using CountFnPtr = menu_index_t (*)(VirtualMenu const& menu);
+
+    //! \brief Callback turning `component` into the entry at `num`
+    using GenerateFnPtr = void (*)(VirtualMenu const& menu, menu_index_t num,
+                                   MenuComponent& component);
+
+public:
+    //! \brief Construct a VirtualMenu
+    //! \param[in] name The name of the menu.
+    //! \param[in] count_fn Returns the number of entries.
+    //! \param[in] generate_fn Turns a pool component into an entry.
+    //! \param[in] pool The reusable components. They must outlive the
+    //!                 menu.
+    //! \param[in] slot_nums pool_size entry numbers, one per pool slot,
+    //!                      kept by the menu.
+    //! \param[in] pool_size The number of components in pool, at least 2.
+    VirtualMenu(const char* name, CountFnPtr count_fn,
+                GenerateFnPtr generate_fn,
+                MenuComponent** pool, menu_index_t* slot_nums,
+                uint8_t pool_size,
+                ComponentCbPtr on_activate=nullptr,
+                ComponentCbPtr on_current=nullptr);
+
+    //! \brief Reads the number of entries again and drops every generated
+    //! entry
+    //!
+    //! Called when the menu is entered; call it when the entries change
+    //! while the menu is shown.
+    void refresh();
+
+    //! \brief Returns the number of the entry `p_component` currently
+    //! stands for, or get_num_components() if it isn't one
+    virtual menu_index_t get_component_num(MenuComponent const* p_component) const;
+
+    virtual bool is_generated() const;
+
+protected:
+    virtual Menu* activate();
+    virtual MenuComponent* get_component(menu_index_t num) const;
+
+private:
+    CountFnPtr _count_fn;
+    GenerateFnPtr _generate_fn;
+    MenuComponent** _pool;
+    uint8_t _pool_size;
+    mutable menu_index_t* _slot_nums;
 };
 
 
+//! \brief What changed in the menu system since the last display
+//!
+//! The values are bit flags combined in MenuChangeSet::changes.
+enum MenuChange : uint8_t {
+    //! Nothing changed; the screen is up to date
+    MENU_CHANGE_NONE = 0,
+    //! The current component moved from previous_component_num to
+    //! current_component_num
+    MENU_CHANGE_CURSOR = 1 << 0,
+    //! The value of the current (focused) component changed
+    MENU_CHANGE_VALUE = 1 << 1,
+    //! The current component gained or lost focus
+    MENU_CHANGE_FOCUS = 1 << 2,
+    //! A menu was entered or left, the system was reset or invalidated;
+    //! everything must be redrawn
+    MENU_CHANGE_MENU = 1 << 3,
+    //! The scroll window of the current menu moved; all visible rows
+    //! changed
+    MENU_CHANGE_SCROLL = 1 << 4
+};
+
+//! \brief The changes passed to MenuComponentRenderer::render since the
+//! previous display
+//!
+//! \see MenuSystem::display
+struct MenuChangeSet {
+    //! MenuChange flags
+    uint8_t changes;
+    //! The current component number at the previous display
+    menu_index_t previous_component_num;
+    //! The current component number now
+    menu_index_t current_component_num;
+
+    //! \brief Returns true if any of the given MenuChange flags is set
+    bool has(uint8_t change) const { return (changes & change) != 0; }
+};
+
+//! \brief Maximum depth of a path passed to MenuSystem::jump_to_path,
+//! root level included
+#ifndef MENUSYSTEM_MAX_DEPTH
+#define MENUSYSTEM_MAX_DEPTH 16
+#endif
+
+//! \brief Size of the largest state written by MenuSystem::save_state
+#define MENUSYSTEM_STATE_SIZE (1 + MENUSYSTEM_MAX_DEPTH * sizeof(menu_index_t))
+
+//! \brief Id of the root's parent in a MenuIndexEntry
+#define MENU_INDEX_NONE UINT16_MAX
+
+//! \brief An entry of the component index built by
+//! MenuSystem::build_index
+//!
+//! The entry's position in the index is the component's id. Ids are
+//! assigned in breadth-first order from the root, which has id 0, so they
+//! stay stable as long as the tree isn't changed.
+struct MenuIndexEntry {
+    MenuComponent const* component;
+    //! Id of the parent menu, MENU_INDEX_NONE for the root
+    uint16_t parent_id;
+    //! Number of the component in its parent menu
+    menu_index_t component_num;
+    //! Number of menus above the component
+    uint8_t depth;
+};
+
+//! \brief An input event for MenuSystem::process
+enum MenuEvent : uint8_t {
+    MENU_EVENT_NEXT,
+    MENU_EVENT_PREV,
+    MENU_EVENT_ACTIVATE,
+    MENU_EVENT_BACK,
+    MENU_EVENT_RESET
+};
+
+//! \brief Navigates a tree of MenuComponent
+//!
+//! The cursor lives in the components themselves, so a tree is navigated
+//! by one MenuSystem only. To run several user interfaces over one tree,
+//! declare it as a MenuTable and give each a MenuTableSystem.
 class MenuSystem {
 public:
   MenuSystem(MenuComponentRenderer const& renderer, const char* name="");
 
+    //! \brief Construct a MenuSystem without a MenuComponentRenderer
+    //!
+    //! Render it with the display(Renderer const&) template instead.
+    explicit MenuSystem(const char* name="");
+
+    //! \brief Construct a MenuSystem around a root menu owned by the caller
+    //!
+    //! Unlike the constructors above, nothing is allocated for the root,
+    //! e.g. when the tree is built in a MenuArena. `root` must outlive the
+    //! MenuSystem.
+    MenuSystem(Menu& root, MenuComponentRenderer const& renderer);
+
+    //! \brief Construct a MenuSystem around a root menu owned by the
+    //! caller, without a MenuComponentRenderer
+    explicit MenuSystem(Menu& root);
+
+    //! \brief Frees the root menu, unless the caller owns it
+    ~MenuSystem();
+
+    MenuSystem(MenuSystem const&) = delete;
+    MenuSystem& operator=(MenuSystem const&) = delete;
+
+    //! \brief Renders the current menu
+    //!
+    //! The renderer receives the changes made since the previous display
+    //! through MenuComponentRenderer::render(Menu const&,
+    //! MenuChangeSet const&), so it can repaint only what's affected.
     void display() const;
+
+    //! \brief Renders the current menu with a statically dispatched
+    //! renderer
+    //!
+    //! Renderer is any class, usually not derived from
+    //! MenuComponentRenderer, providing
+    //!
+    //! \code
+    //! uint8_t get_visible_count() const;
+    //! void render(Menu const& menu, MenuChangeSet const& changes) const;
+    //! \endcode
+    //!
+    //! plus the render overloads of MenuComponentRenderer for the
+    //! components, which it calls through menu_static_render. Every call is
+    //! resolved at compile time and can be inlined; the renderer needs no
+    //! vtable.
+    //!
+    //! \see menu_static_render
+    template <typename Renderer>
+    void display(Renderer const& renderer) const {
+        MenuChangeSet changes;
+        Menu const& menu = begin_display(renderer.get_visible_count(),
+                                         changes);
+        MENU_STATS(++menu_stats.num_display);
+        MENU_STATS(const uint32_t start = menu_stats_now());
+        renderer.render(menu, changes);
+        MENU_STATS(menu_stats_add_render_time(start));
+        end_display(changes);
+    }
+
+    //! \brief Forces the next display to redraw everything
+    //!
+    //! Call it after changing something the menu system can't see, e.g.
+    //! a value set with NumericMenuItem::set_value or a screen overwritten
+    //! by a callback.
+    void invalidate();
+
+    //! \brief Returns the MenuChange flags accumulated since the last
+    //! display
+    uint8_t get_changes() const;
+
     bool next(bool loop=false);
     bool prev(bool loop=false);
     void activate();
     bool back();
+
+    //! \brief Goes back `levels` times in one call
+    //!
+    //! Each level is what back() does: a focused component loses focus,
+    //! otherwise the current menu is left. No callbacks are called.
+    //!
+    //! \returns true if anything changed.
+    bool back(uint8_t levels);
+
+    //! \brief Goes back until the root menu is current
+    //!
+    //! The root menu's cursor stays on the submenu the user came from.
+    //!
+    //! \returns true if anything changed.
+    bool back_to_root();
+
     void reset();
 
+    //! \brief Processes a batch of input events
+    //!
+    //! Runs of MENU_EVENT_NEXT and MENU_EVENT_PREV are coalesced: the
+    //! cursor moves straight to the component the run would end on and
+    //! only that component's on_current callback is called (none if the
+    //! run ends where it started). The end position is the same as calling
+    //! next/prev once per event. While a component has focus the run is
+    //! applied to it as usual. Other events are processed in order.
+    //!
+    //! If anything changed, display is called once at the end.
+    //!
+    //! \param[in] events The events, oldest first.
+    //! \param[in] num_events The number of events.
+    //! \param[in] loop Passed to next and prev.
+    //! \returns true if the menu changed and was displayed.
+    bool process(const MenuEvent* events, size_t num_events, bool loop=false);
+
+    //! \brief Processes a batch of input events held in two runs, such as
+    //! the two ends of a ring buffer
+    //!
+    //! The same as process on `events` followed by `more_events`: runs of
+    //! moves are coalesced across the split and display is called at most
+    //! once.
+    //!
+    //! \returns true if the menu changed and was displayed.
+    bool process(const MenuEvent* events, size_t num_events,
+                 const MenuEvent* more_events, size_t num_more_events,
+                 bool loop=false);
+
+    //! \brief Makes a component current without replaying navigation
+    //!
+    //! The menus leading to the component are entered and the component
+    //! becomes the current one of its parent menu, as if the user had
+    //! navigated there. No on_activate callbacks are called, and neither are
+    //! the on_current callbacks of the components passed on the way.
+    //! Menus left on the way are reset as back() would.
+    //!
+    //! \param[in] component_nums The number of the component to select at
+    //!                           each level, starting in the root menu.
+    //! \param[in] depth The number of entries in component_nums, at least 1
+    //!                  and at most MENUSYSTEM_MAX_DEPTH.
+    //! \param[in] notify If true the target's on_current callback is
+    //!                   called.
+    //! \returns false, leaving the state untouched, if the path doesn't
+    //!          exist.
+    bool jump_to_path(const menu_index_t* component_nums, uint8_t depth,
+                      bool notify=true);
+
+    //! \brief Jumps to the component named by a path such as
+    //! "Settings/Display/Brightness"
+    //!
+    //! Names are matched from the root menu; the first match at each level
+    //! is used. Costs O(depth * width) name comparisons.
+    //!
+    //! \see jump_to_path
+    bool jump_to(const char* path, bool notify=true);
+
+    //! \brief Jumps to a component of the tree
+    //!
+    //! \see jump_to_path
+    bool jump_to(MenuComponent const* p_component, bool notify=true);
+
+    //! \brief Indexes every component of the tree for jump_to_id
+    //!
+    //! The entries array is kept by the MenuSystem until the next call.
+    //! Rebuild the index after changing the tree.
+    //!
+    //! \param[out] entries Storage for the index.
+    //! \param[in] max_entries The number of entries available.
+    //! \returns The number of components indexed, or 0 if they don't fit.
+    //!
+    //! \see MenuIndexEntry
+    uint16_t build_index(MenuIndexEntry* entries, uint16_t max_entries);
+
+    //! \brief Jumps to a component by its id in O(depth)
+    //!
+    //! \see build_index
+    //! \see jump_to_path
+    bool jump_to_id(uint16_t id, bool notify=true);
+
+    //! \brief Encodes the navigation state into `buffer`
+    //!
+    //! The state is the path of current components from the root to the
+    //! current menu and whether the current component has focus. It takes
+    //! 1 + depth * sizeof(menu_index_t) bytes, at most MENUSYSTEM_STATE_SIZE.
+    //! Keep it somewhere that survives a reset, e.g. with MenuStorage or in
+    //! a noinit RAM section, and pass it to restore_state after the tree was
+    //! rebuilt.
+    //!
+    //! An empty current menu is saved as its parent with the menu current.
+    //!
+    //! \param[out] buffer Storage for the state.
+    //! \param[in] size The number of bytes available.
+    //! \returns The number of bytes written, or 0 if they don't fit or the
+    //!          root menu is empty.
+    //!
+    //! \see restore_state
+    uint8_t save_state(uint8_t* buffer, uint8_t size) const;
+
+    //! \brief Restores a state encoded by save_state in O(depth)
+    //!
+    //! Works as jump_to_path: no on_activate callbacks are called, nor the
+    //! on_current callbacks of the menus on the way, and a focused
+    //! NumericMenuItem or SteppedMenuItem gets its focus back without its
+    //! callbacks; the focus of any other component is ignored. The cursor
+    //! path must still exist in the tree; a VirtualMenu on it must have
+    //! been refreshed.
+    //!
+    //! \param[in] buffer The state.
+    //! \param[in] size The number of bytes in buffer.
+    //! \param[in] notify If true the on_current callback of the restored
+    //!                   current component is called.
+    //! \returns false, leaving the state untouched, if the state is
+    //!          malformed or its path doesn't exist.
+    //!
+    //! \see save_state
+    bool restore_state(const uint8_t* buffer, uint8_t size,
+                       bool notify=false);
+
     Menu& get_root_menu() const;
     Menu const* get_current_menu() const;
 
+private:
+    //! \brief Applies the run of next/prev events starting at event `i`
+    //! of both runs; returns the number of the first event after it.
+    size_t process_moves(const MenuEvent* events, size_t num_events,
+                         const MenuEvent* more_events,
+                         size_t num_more_events, size_t i, bool loop);
+
+    Menu const& begin_display(uint8_t visible_count,
+                              MenuChangeSet& changes) const;
+    void end_display(MenuChangeSet const& changes) const;
+
 private:
     Menu* _p_root_menu;
     Menu* _p_current_menu;
-    MenuComponentRenderer const& _renderer;
+    MenuComponentRenderer const* _p_renderer;
+    MenuIndexEntry const* _p_index;
+    uint16_t _index_size;
+    mutable uint8_t _changes;
+    mutable menu_index_t _displayed_component_num;
+    bool _owns_root;
 };
 
 
 class MenuComponentRenderer {
 public:
+    //! \brief Renders the current menu given what changed since the
+    //! previous display
+    //!
+    //! Override it to repaint only the affected parts of the screen. The
+    //! default implementation redraws everything with render(Menu const&).
+    //!
+    //! \see MenuChangeSet
+    virtual void render(Menu const& menu, MenuChangeSet const& changes) const;
+
+    //! \brief Returns how many components the display shows at once
+    //!
+    //! MenuSystem::display uses it to size the scroll window of the
+    //! current menu, so render can iterate over
+    //! Menu::get_visible_component only. The default, 0, shows all
+    //! components.
+    virtual uint8_t get_visible_count() const;
+
     virtual void render(MenuItem const& menu_item) const = 0;
     virtual void render(BackMenuItem const& menu_item) const = 0;
     virtual void render(NumericMenuItem const& menu_item) const = 0;
     virtual void render(Menu const& menu) const = 0;
+
+    //! \brief Renders a SteppedMenuItem
+    //!
+    //! The default implementation renders it as a plain MenuItem.
+    virtual void render(SteppedMenuItem const& menu_item) const;
 };
 
 
+//! \brief Renders a component with a statically dispatched renderer
+//!
+//! Selects the render overload of `renderer` from the component's
+//! MenuComponentKind instead of the two virtual calls of
+//! MenuComponent::render and MenuComponentRenderer::render. Components of
+//! custom subclasses are rendered as their library base class.
+//!
+//! \see MenuSystem::display(Renderer const&)
+template <typename Renderer>
+inline void menu_static_render(Renderer const& renderer,
+                               MenuComponent const& component) {
+    MENU_STATS(++menu_stats.num_renders[component.get_kind()]);
+    switch (component.get_kind()) {
+    case MENU_COMPONENT_BACK:
+        renderer.render(static_cast<BackMenuItem const&>(component));
+        break;
+    case MENU_COMPONENT_NUMERIC:
+        renderer.render(static_cast<NumericMenuItem const&>(component));
+        break;
+    case MENU_COMPONENT_STEPPED:
+        renderer.render(static_cast<SteppedMenuItem const&>(component));
+        break;
+    case MENU_COMPONENT_MENU:
+        renderer.render(static_cast<Menu const&>(component));
+        break;
+    default:
+        renderer.render(static_cast<MenuItem const&>(component));
+        break;
+    }
+}
+
 #endif
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "MenuTable.h"
+
+// *********************************************************
+// MenuTableSystem
+// *********************************************************
+
+MenuTableSystem::MenuTableSystem(
+  MenuTable const& table, MenuTableRenderer const& renderer, float* values)
+: _table(table),
+  _renderer(renderer),
+  _values(values),
+  _depth(0),
+  _is_active(false) {
+    for (uint8_t i = 0; i < _table.num_ranges; ++i)
+        _values[i] = _table.ranges[i].value;
+    _path[0] = 0;
+    _menus[0] = 0;
+}
+
+MenuTableSystem::MenuTableSystem(
+  MenuTableSystem const& session, MenuTableRenderer const& renderer)
+: _table(session._table),
+  _renderer(renderer),
+  _values(session._values),
+  _depth(0),
+  _is_active(false) {
+    _path[0] = 0;
+    _menus[0] = 0;
+}
+
+MenuTable const& MenuTableSystem::get_table() const {
+    return _table;
+}
+
+MenuNode const& MenuTableSystem::get_node(uint8_t node_num) const {
+    return _table.nodes[node_num];
+}
+
+uint8_t MenuTableSystem::get_current_menu() const {
+    return _menus[_depth];
+}
+
+uint8_t MenuTableSystem::get_current_node() const {
+    return _table.nodes[_menus[_depth]].first + _path[_depth];
+}
+
+uint8_t MenuTableSystem::get_current_component_num() const {
+    return _path[_depth];
+}
+
+uint8_t MenuTableSystem::get_depth() const {
+    return _depth;
+}
+
+bool MenuTableSystem::is_active() const {
+    return _is_active;
+}
+
+float MenuTableSystem::get_value(uint8_t node_num) const {
+    return _values[_table.nodes[node_num].first];
+}
+
+void MenuTableSystem::set_value(uint8_t node_num, float value) {
+    _values[_table.nodes[node_num].first] = value;
+}
+
+void MenuTableSystem::set_current(uint8_t component_num) {
+    _path[_depth] = component_num;
+    notify_current();
+}
+
+void MenuTableSystem::notify_current() const {
+    const uint8_t node_num = get_current_node();
+    MenuNodeCbPtr on_current = _table.nodes[node_num].on_current;
+    if (on_current != nullptr)
+        on_current(const_cast<MenuTableSystem&>(*this), node_num);
+}
+
+bool MenuTableSystem::next(bool loop) {
+    const uint8_t num_components = _table.nodes[_menus[_depth]].count;
+    if (!num_components)
+        return false;
+
+    if (_is_active) {
+        const uint8_t slot = _table.nodes[get_current_node()].first;
+        MenuNumericRange const& range = _table.ranges[slot];
+        _values[slot] += range.increment;
+        if (_values[slot] > range.max_value)
+            _values[slot] = loop ? range.min_value : range.max_value;
+        return true;
+    }
+
+    if (_path[_depth] != num_components - 1) {
+        set_current(_path[_depth] + 1);
+        return true;
+    } else if (loop) {
+        set_current(0);
+        return true;
+    }
+    return false;
+}
+
+bool MenuTableSystem::prev(bool loop) {
+    const uint8_t num_components = _table.nodes[_menus[_depth]].count;
+    if (!num_components)
+        return false;
+
+    if (_is_active) {
+        const uint8_t slot = _table.nodes[get_current_node()].first;
+        MenuNumericRange const& range = _table.ranges[slot];
+        _values[slot] -= range.increment;
+        if (_values[slot] < range.min_value)
+            _values[slot] = loop ? range.max_value : range.min_value;
+        return true;
+    }
+
+    if (_path[_depth] != 0) {
+        set_current(_path[_depth] - 1);
+        return true;
+    } else if (loop) {
+        set_current(num_components - 1);
+        return true;
+    }
+    return false;
+}
+
+void MenuTableSystem::activate() {
+    if (!_table.nodes[_menus[_depth]].count)
+        return;
+
+    const uint8_t node_num = get_current_node();
+    MenuNode const& node = _table.nodes[node_num];
+
+    switch (node.kind) {
+    case MENU_NODE_NUMERIC:
+        // Only run on_activate when the user is done editing the value
+        _is_active = !_is_active;
+        if (!_is_active && node.on_activate != nullptr)
+            node.on_activate(*this, node_num);
+        break;
+    case MENU_NODE_MENU:
+        if (node.on_activate != nullptr)
+            node.on_activate(*this, node_num);
+        // Empty menus and menus nested too deeply are not entered
+        if (node.count && _depth + 1 < MENU_TABLE_MAX_DEPTH) {
+            ++_depth;
+            _menus[_depth] = node_num;
+            set_current(0);
+        }
+        break;
+    case MENU_NODE_BACK:
+        if (node.on_activate != nullptr)
+            node.on_activate(*this, node_num);
+        back();
+        break;
+    default:
+        if (node.on_activate != nullptr)
+            node.on_activate(*this, node_num);
+        break;
+    }
+}
+
+bool MenuTableSystem::back() {
+    // Deactivate current node if it has focus
+    if (_is_active) {
+        _is_active = false;
+        return true;
+    }
+    // Go 1 level up if no node was active
+    if (_depth > 0) {
+        --_depth;
+        return true;
+    }
+    // We are already in the root menu
+    return false;
+}
+
+void MenuTableSystem::reset() {
+    _depth = 0;
+    _is_active = false;
+    _path[0] = 0;
+    if (_table.nodes[0].count)
+        notify_current();
+}
+
+void MenuTableSystem::display() const {
+    _renderer.render(*this);
+}
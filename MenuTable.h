@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#ifndef MENUTABLE_H
+#define MENUTABLE_H
+
+#include <stdint.h>
+
+//! \brief Maximum nesting depth of a MenuTable, root included
+#ifndef MENU_TABLE_MAX_DEPTH
+#define MENU_TABLE_MAX_DEPTH 8
+#endif
+
+class MenuTableRenderer;
+class MenuTableSystem;
+
+//! \brief The kind of a MenuNode
+//!
+//! The kinds mirror the classes of the object based menu: MenuItem,
+//! BackMenuItem, NumericMenuItem and Menu.
+enum MenuNodeKind : uint8_t {
+    MENU_NODE_ITEM,
+    MENU_NODE_BACK,
+    MENU_NODE_NUMERIC,
+    MENU_NODE_MENU
+};
+
+//! \brief Callback for when a MenuNode is activated or becomes current
+//!
+//! \param ms The MenuTableSystem navigating the table.
+//! \param node_num The index of the node in the table.
+using MenuNodeCbPtr = void (*)(MenuTableSystem& ms, uint8_t node_num);
+
+//! \brief An immutable entry of a MenuTable
+//!
+//! A MenuNode holds no navigation state, so a whole table can be declared
+//! `constexpr` and placed in flash. The children of a menu node are stored
+//! next to each other in the table: `first` is the index of the first child
+//! and `count` the number of children. For numeric nodes `first` is the
+//! index of the node's MenuNumericRange and its value slot.
+//!
+//! Use menu_node, item_node, back_node and numeric_node to declare nodes.
+//!
+//! \see MenuTable
+struct MenuNode {
+    const char* name;
+    MenuNodeKind kind;
+    uint8_t first;
+    uint8_t count;
+    MenuNodeCbPtr on_activate;
+    MenuNodeCbPtr on_current;
+};
+
+//! \brief The limits of a numeric node
+//!
+//! \see NumericMenuItem
+struct MenuNumericRange {
+    float value;
+    float min_value;
+    float max_value;
+    float increment;
+};
+
+//! \brief An immutable menu tree
+//!
+//! Node 0 is the root menu. The only mutable data the tree needs are the
+//! values of its numeric nodes, which are kept by the MenuTableSystem.
+//!
+//! \see MenuTableSystem
+struct MenuTable {
+    const MenuNode* nodes;
+    uint8_t num_nodes;
+    const MenuNumericRange* ranges;
+    uint8_t num_ranges;
+};
+
+//! \brief Declares a menu node whose children are the `count` nodes
+//! starting at `first`
+constexpr MenuNode menu_node(const char* name, uint8_t first, uint8_t count,
+                             MenuNodeCbPtr on_activate=nullptr,
+                             MenuNodeCbPtr on_current=nullptr) {
+    return MenuNode{name, MENU_NODE_MENU, first, count,
+                    on_activate, on_current};
+}
+
+//! \brief Declares a node that calls on_activate when activated
+constexpr MenuNode item_node(const char* name,
+                             MenuNodeCbPtr on_activate=nullptr,
+                             MenuNodeCbPtr on_current=nullptr) {
+    return MenuNode{name, MENU_NODE_ITEM, 0, 0, on_activate, on_current};
+}
+
+//! \brief Declares a node that goes back one level when activated
+constexpr MenuNode back_node(const char* name,
+                             MenuNodeCbPtr on_activate=nullptr,
+                             MenuNodeCbPtr on_current=nullptr) {
+    return MenuNode{name, MENU_NODE_BACK, 0, 0, on_activate, on_current};
+}
+
+//! \brief Declares a numeric node using the range and value slot `range`
+constexpr MenuNode numeric_node(const char* name, uint8_t range,
+                                MenuNodeCbPtr on_activate=nullptr,
+                                MenuNodeCbPtr on_current=nullptr) {
+    return MenuNode{name, MENU_NODE_NUMERIC, range, 0,
+                    on_activate, on_current};
+}
+
+//! \brief Checks at compile time that every menu node's children lie
+//! inside the table and after the menu itself
+//!
+//! \code
+//! static_assert(menu_nodes_valid(nodes), "invalid menu table");
+//! \endcode
+template <uint8_t N>
+constexpr bool menu_nodes_valid(const MenuNode (&nodes)[N], uint8_t i=0) {
+    return i >= N
+        || ((nodes[i].kind != MENU_NODE_MENU
+             || (nodes[i].first > i
+                 && nodes[i].first + nodes[i].count <= N))
+            && menu_nodes_valid(nodes, i + 1));
+}
+
+
+//! \brief Navigates a MenuTable
+//!
+//! MenuTableSystem is the table counterpart of MenuSystem: it offers the same
+//! next/prev/activate/back/reset/display operations but keeps all mutable
+//! state itself: the child index chosen at every level of the cursor path,
+//! whether the current numeric node is being edited and the numeric values.
+//!
+//! Since the table is never written, several MenuTableSystem sessions can
+//! navigate it at once, e.g. a serial console and a front panel, each with
+//! its own cursor and renderer. Sessions made with the sharing constructor
+//! also share the values, so a value set in one shows in the others.
+//!
+//! \code
+//! float values[NUM_VALUES];
+//! MenuTableSystem console(table, console_renderer, values);
+//! MenuTableSystem panel(console, panel_renderer);
+//! \endcode
+//!
+//! \see MenuSystem
+class MenuTableSystem {
+public:
+    //! \brief Construct a MenuTableSystem
+    //! \param[in] table The tree to navigate.
+    //! \param[in] renderer The renderer used by display.
+    //! \param[in] values Storage for one value per numeric range of the
+    //!                   table. It is initialised from the ranges.
+    MenuTableSystem(MenuTable const& table,
+                    MenuTableRenderer const& renderer, float* values);
+
+    //! \brief Construct a session sharing the table and the values of
+    //! `session`
+    //!
+    //! The new session starts at the root with its own cursor. The values
+    //! are left as they are.
+    //!
+    //! \param[in] session The session whose table and values are shared.
+    //! \param[in] renderer The renderer used by display.
+    MenuTableSystem(MenuTableSystem const& session,
+                    MenuTableRenderer const& renderer);
+
+    void display() const;
+    bool next(bool loop=false);
+    bool prev(bool loop=false);
+    void activate();
+    bool back();
+    void reset();
+
+    MenuTable const& get_table() const;
+    MenuNode const& get_node(uint8_t node_num) const;
+
+    //! \brief Returns the node number of the current menu
+    uint8_t get_current_menu() const;
+
+    //! \brief Returns the node number of the current child of the current
+    //! menu
+    uint8_t get_current_node() const;
+
+    //! \brief Returns the index of the current node in the current menu
+    uint8_t get_current_component_num() const;
+
+    //! \brief Returns the number of menus entered below the root
+    uint8_t get_depth() const;
+
+    //! \brief Returns true if the current numeric node has focus; next
+    //! and prev then change its value.
+    bool is_active() const;
+
+    float get_value(uint8_t node_num) const;
+    void set_value(uint8_t node_num, float value);
+
+private:
+    void set_current(uint8_t component_num);
+    void notify_current() const;
+
+private:
+    MenuTable const& _table;
+    MenuTableRenderer const& _renderer;
+    float* _values;
+    uint8_t _path[MENU_TABLE_MAX_DEPTH];
+    uint8_t _menus[MENU_TABLE_MAX_DEPTH];
+    uint8_t _depth;
+    bool _is_active;
+};
+
+
+class MenuTableRenderer {
+public:
+    virtual void render(MenuTableSystem const& ms) const = 0;
+};
+
+#endif
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "TextGridRenderer.h"
+#include <stdlib.h>
+#include <string.h>
+
+// A cell value draw_text never writes, marking cells the display may not
+// show as the shadow says.
+static const char CELL_UNKNOWN = '\0';
+
+TextGridRenderer::TextGridRenderer(uint8_t columns, uint8_t rows)
+: _columns(columns),
+  _rows(rows),
+  _frame((char*) malloc(2 * columns * rows)),
+  _shadow(_frame),
+  _row(0),
+  _in_menu(false) {
+    // Without buffers nothing is drawn
+    if (_frame == nullptr) {
+        _columns = 0;
+        _rows = 0;
+    }
+    _shadow += _columns * _rows;
+    clear_frame();
+    invalidate();
+}
+
+TextGridRenderer::~TextGridRenderer() {
+    free(_frame);
+}
+
+uint8_t TextGridRenderer::get_columns() const {
+    return _columns;
+}
+
+uint8_t TextGridRenderer::get_rows() const {
+    return _rows;
+}
+
+uint8_t TextGridRenderer::get_visible_count() const {
+    return _rows;
+}
+
+void TextGridRenderer::invalidate() {
+    memset(_shadow, CELL_UNKNOWN, _columns * _rows);
+}
+
+void TextGridRenderer::clear_frame() const {
+    memset(_frame, ' ', _columns * _rows);
+}
+
+uint8_t TextGridRenderer::draw_text(uint8_t column, uint8_t row,
+                                    const char* text) const {
+    if (row >= _rows)
+        return column;
+    char* cell = _frame + row * _columns;
+    for (; column < _columns && *text != '\0'; ++column)
+        cell[column] = *text++;
+    return column;
+}
+
+void TextGridRenderer::flush() const {
+    // Where the display cursor is; _columns when it's unknown
+    uint8_t cursor_column = _columns;
+    uint8_t cursor_row = 0;
+
+    for (uint8_t row = 0; row < _rows; ++row) {
+        const char* frame = _frame + row * _columns;
+        char* shadow = _shadow + row * _columns;
+
+        uint8_t column = 0;
+        while (column < _columns) {
+            if (frame[column] == shadow[column]) {
+                ++column;
+                continue;
+            }
+
+            // Extend the run over changed cells. A single unchanged cell
+            // is rewritten rather than paying for another cursor move.
+            uint8_t end = column + 1;
+            while (end < _columns) {
+                if (frame[end] != shadow[end])
+                    ++end;
+                else if (end + 1 < _columns
+                         && frame[end + 1] != shadow[end + 1])
+                    end += 2;
+                else
+                    break;
+            }
+
+            if (cursor_row != row || cursor_column != column)
+                set_cursor(column, row);
+            print(frame + column, end - column);
+            memcpy(shadow + column, frame + column, end - column);
+
+            // Past the end of a row the cursor position depends on the
+            // display's memory layout
+            cursor_column = end;
+            cursor_row = row;
+            column = end;
+        }
+    }
+}
+
+void TextGridRenderer::render(Menu const& menu) const {
+    // A submenu listed in the displayed menu shows its name
+    if (_in_menu) {
+        draw_text(1, _row, menu.get_name());
+        return;
+    }
+
+    clear_frame();
+    _in_menu = true;
+    MenuComponent const* p_current = menu.get_current_component();
+    for (menu_index_t i = 0; i < menu.get_num_visible() && i < _rows; ++i) {
+        MenuComponent const* p_component = menu.get_visible_component(i);
+        _row = i;
+        if (p_component == p_current)
+            draw_text(0, _row, p_component->is_active() ? "*" : ">");
+        p_component->render(*this);
+    }
+    _in_menu = false;
+    flush();
+}
+
+void TextGridRenderer::render(MenuItem const& menu_item) const {
+    draw_text(1, _row, menu_item.get_name());
+}
+
+void TextGridRenderer::render(BackMenuItem const& menu_item) const {
+    draw_text(1, _row, menu_item.get_name());
+}
+
+void TextGridRenderer::render(NumericMenuItem const& menu_item) const {
+    char buffer[16];
+    menu_item.format_value(buffer, sizeof(buffer));
+    draw_value(menu_item, buffer);
+}
+
+void TextGridRenderer::render(SteppedMenuItem const& menu_item) const {
+    char buffer[16];
+    menu_item.format_value(buffer, sizeof(buffer));
+    draw_value(menu_item, buffer);
+}
+
+void TextGridRenderer::draw_value(MenuComponent const& component,
+                                  const char* value) const {
+    draw_text(1, _row, component.get_name());
+    const size_t length = strlen(value);
+    draw_text(length < _columns ? _columns - length : 0, _row, value);
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#ifndef TEXTGRIDRENDERER_H
+#define TEXTGRIDRENDERER_H
+
+#include <stdint.h>
+
+#include "MenuSystem.h"
+
+//! \brief Base class for renderers drawing on a character display
+//!
+//! A TextGridRenderer composes every frame in RAM and keeps a shadow copy
+//! of what the display shows. TextGridRenderer::flush compares the two and
+//! sends only the runs of cells that changed, each preceded by a cursor move
+//! unless the display cursor is already there. The display is never
+//! cleared, which on an HD44780 alone takes 1.5 ms.
+//!
+//! Subclasses implement set_cursor and print for their display. The
+//! default layout lists the scroll window of the current menu, one
+//! component per row, with `>` in front of the current component (`*`
+//! while it has focus) and numeric values aligned right. Override the
+//! render methods to change it, drawing with draw_text and finishing with
+//! flush.
+//!
+//! The frame and the shadow copy take `columns * rows` bytes each.
+//!
+//! \see MenuComponentRenderer
+class TextGridRenderer : public MenuComponentRenderer {
+public:
+    //! \brief Construct a TextGridRenderer
+    //! \param[in] columns The number of characters per row.
+    //! \param[in] rows The number of rows.
+    TextGridRenderer(uint8_t columns, uint8_t rows);
+    virtual ~TextGridRenderer();
+
+    //! A copy would free the same frame twice
+    TextGridRenderer(TextGridRenderer const&) = delete;
+    TextGridRenderer& operator=(TextGridRenderer const&) = delete;
+
+    uint8_t get_columns() const;
+    uint8_t get_rows() const;
+
+    //! \brief Returns the number of rows
+    virtual uint8_t get_visible_count() const;
+
+    //! \brief Forgets what the display shows, so the next flush rewrites
+    //! every cell
+    //!
+    //! Call it after the display was cleared or written by other code.
+    void invalidate();
+
+    //! \brief Fills the frame with spaces
+    void clear_frame() const;
+
+    //! \brief Writes text into the frame, clipped at the end of the row
+    //! \returns The column after the last character written.
+    uint8_t draw_text(uint8_t column, uint8_t row, const char* text) const;
+
+    //! \brief Sends the cells of the frame that differ from the display
+    void flush() const;
+
+    using MenuComponentRenderer::render;
+    virtual void render(Menu const& menu) const;
+    virtual void render(MenuItem const& menu_item) const;
+    virtual void render(BackMenuItem const& menu_item) const;
+    virtual void render(NumericMenuItem const& menu_item) const;
+    virtual void render(SteppedMenuItem const& menu_item) const;
+
+protected:
+    //! \brief Moves the display cursor
+    virtual void set_cursor(uint8_t column, uint8_t row) const = 0;
+
+    //! \brief Writes `length` characters at the display cursor, which
+    //! advances past them
+    virtual void print(const char* text, uint8_t length) const = 0;
+
+private:
+    //! \brief Draws a row of the default layout showing a value
+    void draw_value(MenuComponent const& component, const char* value) const;
+
+private:
+    uint8_t _columns;
+    uint8_t _rows;
+    char* _frame;
+    char* _shadow;
+    //! The row the default layout is drawing
+    mutable uint8_t _row;
+    //! True while the components of a menu are drawn
+    mutable bool _in_menu;
+};
+
+#endif
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "TextStreamRenderer.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Cursor home, clear to the end of the line and to the end of the screen
+static const char ANSI_HOME[] = "\x1b[H";
+static const char ANSI_CLEAR_LINE[] = "\x1b[K";
+static const char ANSI_CLEAR_BELOW[] = "\x1b[J";
+
+TextStreamRenderer::TextStreamRenderer(uint16_t buffer_size,
+                                       uint8_t visible_count, bool ansi)
+: _buffer((char*) malloc(buffer_size)),
+  _size(buffer_size),
+  _length(0),
+  _visible_count(visible_count),
+  _is_ansi(ansi),
+  _in_menu(false) {
+    // Without a buffer every append is written through
+    if (_buffer == nullptr)
+        _size = 0;
+}
+
+TextStreamRenderer::~TextStreamRenderer() {
+    free(_buffer);
+}
+
+uint8_t TextStreamRenderer::get_visible_count() const {
+    return _visible_count;
+}
+
+void TextStreamRenderer::set_ansi(bool ansi) {
+    _is_ansi = ansi;
+}
+
+bool TextStreamRenderer::is_ansi() const {
+    return _is_ansi;
+}
+
+void TextStreamRenderer::append(const char* text) const {
+    append(text, strlen(text));
+}
+
+void TextStreamRenderer::append(const char* text, uint16_t length) const {
+    while (length > 0) {
+        if (_length == _size) {
+            flush();
+            if (_size == 0) {
+                write(text, length);
+                return;
+            }
+        }
+        const uint16_t num = length < _size - _length
+            ? length : _size - _length;
+        memcpy(_buffer + _length, text, num);
+        _length += num;
+        text += num;
+        length -= num;
+    }
+}
+
+void TextStreamRenderer::end_line() const {
+    if (_is_ansi)
+        append(ANSI_CLEAR_LINE, sizeof(ANSI_CLEAR_LINE) - 1);
+    append("\r\n", 2);
+}
+
+void TextStreamRenderer::flush() const {
+    if (_length == 0)
+        return;
+    write(_buffer, _length);
+    _length = 0;
+}
+
+void TextStreamRenderer::render(Menu const& menu) const {
+    // A submenu listed in the rendered menu shows its name
+    if (_in_menu) {
+        append(menu.get_name());
+        return;
+    }
+
+    if (_is_ansi)
+        append(ANSI_HOME, sizeof(ANSI_HOME) - 1);
+    else
+        end_line();
+    append(menu.get_name());
+    end_line();
+
+    _in_menu = true;
+    MenuComponent const* p_current = menu.get_current_component();
+    for (menu_index_t i = 0; i < menu.get_num_visible(); ++i) {
+        MenuComponent const* p_component = menu.get_visible_component(i);
+        p_component->render(*this);
+        if (p_component == p_current)
+            append(" <<<", 4);
+        end_line();
+    }
+    _in_menu = false;
+
+    // Lines of a longer previous frame
+    if (_is_ansi)
+        append(ANSI_CLEAR_BELOW, sizeof(ANSI_CLEAR_BELOW) - 1);
+    flush();
+}
+
+void TextStreamRenderer::render(MenuItem const& menu_item) const {
+    append(menu_item.get_name());
+}
+
+void TextStreamRenderer::render(BackMenuItem const& menu_item) const {
+    append(menu_item.get_name());
+}
+
+void TextStreamRenderer::render(NumericMenuItem const& menu_item) const {
+    char buffer[16];
+    menu_item.format_value(buffer, sizeof(buffer));
+    append_value(menu_item, buffer);
+}
+
+void TextStreamRenderer::render(SteppedMenuItem const& menu_item) const {
+    char buffer[16];
+    menu_item.format_value(buffer, sizeof(buffer));
+    append_value(menu_item, buffer);
+}
+
+void TextStreamRenderer::append_value(MenuComponent const& component,
+                                      const char* value) const {
+    append(component.get_name());
+    append(component.is_active() ? "<" : "=", 1);
+    append(value);
+    if (component.is_active())
+        append(">", 1);
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#ifndef TEXTSTREAMRENDERER_H
+#define TEXTSTREAMRENDERER_H
+
+#include <stdint.h>
+
+#include "MenuSystem.h"
+
+//! \brief Base class for renderers writing lines of text to a stream, e.g.
+//! a serial terminal
+//!
+//! A TextStreamRenderer composes every frame in a buffer and hands it to
+//! write in one call, instead of one blocking UART write per name, marker
+//! and line end. Text that doesn't fit the buffer is written as the buffer
+//! fills up, so nothing is lost, but size it for a whole frame.
+//!
+//! By default frames are printed one after the other and the terminal
+//! scrolls. In ANSI mode every frame starts with a cursor home sequence and
+//! lines are cleared to their end, so the terminal shows one frame that is
+//! overwritten in place.
+//!
+//! Subclasses implement write for their stream. The default layout prints
+//! the name of the current menu, then the scroll window of its components,
+//! one per line, with `name=value` for numeric items (`name<value>` while
+//! they have focus) and ` <<<` after the current component. Override the
+//! render methods to change it, composing with append and end_line and
+//! finishing with flush.
+//!
+//! \see MenuComponentRenderer
+class TextStreamRenderer : public MenuComponentRenderer {
+public:
+    //! \brief Construct a TextStreamRenderer
+    //! \param[in] buffer_size The number of bytes of the frame buffer.
+    //! \param[in] visible_count The number of components listed, 0 for all.
+    //! \param[in] ansi True to overwrite frames in place.
+    TextStreamRenderer(uint16_t buffer_size, uint8_t visible_count,
+                       bool ansi=false);
+    virtual ~TextStreamRenderer();
+
+    //! A copy would free the same buffer twice
+    TextStreamRenderer(TextStreamRenderer const&) = delete;
+    TextStreamRenderer& operator=(TextStreamRenderer const&) = delete;
+
+    virtual uint8_t get_visible_count() const;
+
+    void set_ansi(bool ansi);
+    bool is_ansi() const;
+
+    //! \brief Adds text to the frame buffer
+    void append(const char* text) const;
+
+    //! \brief Adds `length` characters to the frame buffer
+    void append(const char* text, uint16_t length) const;
+
+    //! \brief Ends the current line, clearing the rest of it in ANSI mode
+    void end_line() const;
+
+    //! \brief Writes the frame buffer, if not empty, in one call
+    void flush() const;
+
+    using MenuComponentRenderer::render;
+    virtual void render(Menu const& menu) const;
+    virtual void render(MenuItem const& menu_item) const;
+    virtual void render(BackMenuItem const& menu_item) const;
+    virtual void render(NumericMenuItem const& menu_item) const;
+    virtual void render(SteppedMenuItem const& menu_item) const;
+
+protected:
+    //! \brief Writes `size` bytes to the stream
+    virtual void write(const char* data, uint16_t size) const = 0;
+
+private:
+    //! \brief Adds a component of the default layout showing a value
+    void append_value(MenuComponent const& component,
+                      const char* value) const;
+
+private:
+    char* _buffer;
+    uint16_t _size;
+    mutable uint16_t _length;
+    uint8_t _visible_count;
+    bool _is_ansi;
+    //! True while the components of a menu are rendered
+    mutable bool _in_menu;
+};
+
+#endif
@@ -0,0 +1,166 @@
+/*
+ * Host benchmark support for the menu system library.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+
+// *********************************************************
+// Heap call counting
+// *********************************************************
+
+static uint64_t alloc_count = 0;
+static uint64_t free_count = 0;
+
+uint64_t bench_alloc_count() {
+    return alloc_count;
+}
+
+uint64_t bench_free_count() {
+    return free_count;
+}
+
+#ifdef BENCH_WRAP_MALLOC
+// Linked with --wrap so calls made by the library itself are counted too.
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t num, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+
+void* __wrap_malloc(size_t size) {
+    ++alloc_count;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t num, size_t size) {
+    ++alloc_count;
+    return __real_calloc(num, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    ++alloc_count;
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void* ptr) {
+    if (ptr != nullptr)
+        ++free_count;
+    __real_free(ptr);
+}
+}
+#define BENCH_MALLOC(size) __real_malloc(size)
+#define BENCH_FREE(ptr) __real_free(ptr)
+#else
+#define BENCH_MALLOC(size) malloc(size)
+#define BENCH_FREE(ptr) free(ptr)
+#endif
+
+void* operator new(size_t size) {
+    ++alloc_count;
+    void* ptr = BENCH_MALLOC(size ? size : 1);
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    if (ptr != nullptr)
+        ++free_count;
+    BENCH_FREE(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+// *********************************************************
+// Reporting
+// *********************************************************
+
+void bench_header(const char* title) {
+    printf("\n%s\n", title);
+    printf("%-44s %12s %12s %12s\n", "benchmark", "ops", "ns/op", "allocs/op");
+}
+
+void bench_report(const char* name, uint64_t ops, double ns_per_op,
+                  double allocs_per_op) {
+    printf("%-44s %12llu %12.2f %12.3f\n", name, (unsigned long long) ops,
+           ns_per_op, allocs_per_op);
+}
+
+// *********************************************************
+// NullRenderer
+// *********************************************************
+
+void NullRenderer::render(Menu const& menu) const {
+    ++_num_renders;
+    // Submenus listed inside the displayed menu only draw their name.
+    if (_in_menu)
+        return;
+    _in_menu = true;
+    for (menu_index_t i = 0; i < menu.get_num_visible(); ++i)
+        menu.get_visible_component(i)->render(*this);
+    _in_menu = false;
+}
+
+void NullRenderer::render(MenuItem const& menu_item) const {
+    ++_num_renders;
+    bench_keep(menu_item);
+}
+
+void NullRenderer::render(BackMenuItem const& menu_item) const {
+    ++_num_renders;
+    bench_keep(menu_item);
+}
+
+void NullRenderer::render(NumericMenuItem const& menu_item) const {
+    ++_num_renders;
+    char buffer[16];
+    menu_item.format_value(buffer, sizeof(buffer));
+    bench_keep(buffer);
+}
+
+// *********************************************************
+// BenchTree
+// *********************************************************
+
+BenchTree::BenchTree(MenuSystem& ms, menu_index_t width, uint8_t depth)
+: _width(width),
+  _depth(depth) {
+    Menu* p_level = &ms.get_root_menu();
+    for (uint8_t level = 0; level < depth; ++level) {
+        menu_index_t first_item = 0;
+        p_level->reserve(width);
+        if (level + 1 < depth) {
+            _menus.emplace_back(new Menu("Menu"));
+            p_level->add(_menus.back().get());
+            first_item = 1;
+        }
+        for (menu_index_t i = first_item; i < width; ++i) {
+            _items.emplace_back(new MenuItem("Item"));
+            p_level->add(_items.back().get());
+        }
+        if (level + 1 < depth)
+            p_level = _menus.back().get();
+    }
+    ms.reset();
+}
@@ -0,0 +1,104 @@
+/*
+ * Host benchmark support for the menu system library.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <MenuSystem.h>
+
+//! \brief Number of heap calls (malloc, calloc, realloc, operator new)
+//! made by this process so far.
+uint64_t bench_alloc_count();
+
+//! \brief Number of heap releases (free, operator delete) made by this
+//! process so far.
+uint64_t bench_free_count();
+
+//! \brief Prevents the compiler from optimising away a computed value.
+template <typename T>
+inline void bench_keep(T const& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+//! \brief Prints the column header for bench_run results.
+void bench_header(const char* title);
+
+//! \brief Prints one result row.
+void bench_report(const char* name, uint64_t ops, double ns_per_op,
+                  double allocs_per_op);
+
+//! \brief Times `ops` calls of `fn(i)` and prints ns/op and allocs/op.
+//!
+//! The function is run once for ops / 10 iterations to warm caches before
+//! the measured run.
+template <typename Fn>
+void bench_run(const char* name, uint64_t ops, Fn fn) {
+    for (uint64_t i = 0; i < ops / 10; ++i)
+        fn(i);
+
+    const uint64_t allocs = bench_alloc_count();
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < ops; ++i)
+        fn(i);
+    const auto stop = std::chrono::steady_clock::now();
+    const uint64_t allocs_done = bench_alloc_count() - allocs;
+
+    const double ns = std::chrono::duration<double, std::nano>(
+        stop - start).count();
+    bench_report(name, ops, ns / ops, double(allocs_done) / ops);
+}
+
+//! \brief A renderer that draws nothing but visits every component of the
+//! menu the way a typical list renderer does.
+class NullRenderer : public MenuComponentRenderer {
+public:
+    //! \param[in] visible_count The number of lines of the simulated
+    //!                          display, 0 to render every component.
+    explicit NullRenderer(uint8_t visible_count=0)
+    : _num_renders(0), _in_menu(false), _visible_count(visible_count) {}
+
+    uint8_t get_visible_count() const { return _visible_count; }
+
+    void render(Menu const& menu) const;
+    void render(MenuItem const& menu_item) const;
+    void render(BackMenuItem const& menu_item) const;
+    void render(NumericMenuItem const& menu_item) const;
+
+    uint64_t get_num_renders() const { return _num_renders; }
+
+private:
+    mutable uint64_t _num_renders;
+    mutable bool _in_menu;
+    uint8_t _visible_count;
+};
+
+//! \brief A generated menu tree owning all of its components.
+//!
+//! Every level holds `width` components. The first component of every level
+//! except the deepest is a Menu leading to the next level; the remaining
+//! components are MenuItems.
+class BenchTree {
+public:
+    BenchTree(MenuSystem& ms, menu_index_t width, uint8_t depth);
+
+    menu_index_t get_width() const { return _width; }
+    uint8_t get_depth() const { return _depth; }
+
+private:
+    std::vector<std::unique_ptr<Menu>> _menus;
+    std::vector<std::unique_ptr<MenuItem>> _items;
+    menu_index_t _width;
+    uint8_t _depth;
+};
+
+#endif
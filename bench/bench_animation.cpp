@@ -0,0 +1,149 @@
+/*
+ * bench_animation.cpp - Tick-driven transitions on a fake clock.
+ *
+ * A renderer slides from the previous component name to the current one
+ * with MenuAnimator while a simulated main loop handles key presses. It
+ * reports the frames drawn and dropped per transition, and the input
+ * latency compared with a renderer that plays the same transition in a
+ * blocking loop with delays, as led_matrix_animated used to.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "bench.h"
+
+#include <MenuAnimator.h>
+
+#include <stdio.h>
+
+static const uint16_t FRAME_INTERVAL = 20;
+static const uint16_t DURATION = 300;
+
+static uint32_t fake_now = 0;
+
+class Slide : public MenuTransition {
+public:
+    Slide() : _last_progress(0), _ok(true) {}
+
+    void draw_frame(uint8_t progress) const {
+        // Within a transition the progress never goes back
+        if (progress == 0)
+            _last_progress = 0;
+        _ok &= progress >= _last_progress;
+        _last_progress = progress;
+        bench_keep(progress);
+    }
+
+    bool is_ok() const { return _ok; }
+    uint8_t get_last_progress() const { return _last_progress; }
+
+private:
+    mutable uint8_t _last_progress;
+    mutable bool _ok;
+};
+
+class AnimatedRenderer : public MenuComponentRenderer {
+public:
+    AnimatedRenderer(MenuAnimator* p_animator, bool blocking)
+    : _p_animator(p_animator), _blocking(blocking) {}
+
+    void render(Menu const&) const {
+        _p_animator->start(_slide, fake_now, DURATION);
+        // The old way: play the whole transition before returning
+        while (_blocking && _p_animator->is_running()) {
+            fake_now += FRAME_INTERVAL;
+            _p_animator->tick(fake_now);
+        }
+    }
+    void render(MenuItem const&) const {}
+    void render(BackMenuItem const&) const {}
+    void render(NumericMenuItem const&) const {}
+
+    Slide const& get_slide() const { return _slide; }
+
+private:
+    MenuAnimator* _p_animator;
+    bool _blocking;
+    Slide _slide;
+};
+
+struct LoopResult {
+    uint32_t transitions;
+    uint32_t frames_drawn;
+    uint32_t frames_dropped;
+    uint32_t max_latency;
+    bool ok;
+};
+
+// Runs a main loop for 10 s of fake time. Each iteration takes
+// `loop_time`; a key arrives every `key_interval` and is handled by the
+// next iteration.
+static LoopResult run_loop(bool blocking, bool finish_on_input,
+                           uint16_t loop_time, uint16_t key_interval) {
+    MenuAnimator animator(FRAME_INTERVAL);
+    AnimatedRenderer renderer(&animator, blocking);
+    MenuSystem ms(renderer);
+    BenchTree tree(ms, 8, 1);
+
+    LoopResult result = {0, 0, 0, 0, true};
+    fake_now = 0;
+    uint32_t next_key = key_interval;
+    while (fake_now < 10000) {
+        if (fake_now >= next_key) {
+            result.max_latency = fake_now - next_key > result.max_latency
+                ? fake_now - next_key : result.max_latency;
+            if (finish_on_input)
+                animator.finish();
+            ms.next(true);
+            ms.display();
+            ++result.transitions;
+            next_key += key_interval;
+        }
+        animator.tick(fake_now);
+        if (result.transitions && !animator.is_running())
+            result.ok &= renderer.get_slide().get_last_progress()
+                == MENU_TRANSITION_END;
+        result.ok &= renderer.get_slide().is_ok();
+        fake_now += loop_time;
+    }
+    result.frames_drawn = animator.get_frames_drawn();
+    result.frames_dropped = animator.get_frames_dropped();
+    return result;
+}
+
+static bool report(const char* name, LoopResult const& result) {
+    printf("%-44s %12.1f %12.1f %12u %6s\n", name,
+           double(result.frames_drawn) / result.transitions,
+           double(result.frames_dropped) / result.transitions,
+           (unsigned) result.max_latency, result.ok ? "yes" : "NO");
+    return result.ok;
+}
+
+int main() {
+    printf("\n%u ms transitions, a frame every %u ms\n", DURATION,
+           FRAME_INTERVAL);
+    printf("%-44s %12s %12s %12s %6s\n", "main loop", "drawn/trans",
+           "dropped/tr", "latency ms", "ok");
+
+    bool ok = true;
+    ok &= report("1 ms loop, key every 500 ms",
+                 run_loop(false, false, 1, 500));
+    ok &= report("45 ms loop, key every 500 ms",
+                 run_loop(false, false, 45, 500));
+    ok &= report("1 ms loop, key every 100 ms, finish on key",
+                 run_loop(false, true, 1, 100));
+    ok &= report("1 ms loop, key every 100 ms, restart on key",
+                 run_loop(false, false, 1, 100));
+    ok &= report("blocking render, key every 100 ms",
+                 run_loop(true, false, 1, 100));
+
+    MenuAnimator animator(FRAME_INTERVAL);
+    Slide slide;
+    animator.start(slide, 0, DURATION);
+    bench_header("tick cost");
+    bench_run("tick (no frame due)", 1000000, [&](uint64_t) {
+        animator.tick(1);
+    });
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,247 @@
+/*
+ * bench_arena.cpp - Building a menu tree in a MenuArena.
+ *
+ * Builds the same tree of 4 groups of 10 numeric items three ways: with
+ * caller-owned components and Menu::add, in a MenuArena on a static
+ * buffer and in a MenuArena on one malloc'd buffer sized by
+ * MenuArena::menu_size_of and size_of. Counts the heap calls made while
+ * building and tearing down each, checks that both arena trees match the
+ * heap one, that the computed size is exact, that a short arena fails
+ * cleanly and that teardown destroys every component, last first.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "bench.h"
+
+#include <MenuArena.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory>
+#include <vector>
+
+static const menu_index_t NUM_GROUPS = 4;
+static const menu_index_t NUM_VALUES = 10;
+
+// Components constructed and not yet destroyed, and whether every one was
+// destroyed after all those constructed later
+static uint32_t num_live = 0;
+static bool destroyed_in_order = true;
+
+class CountedItem : public MenuItem {
+public:
+    explicit CountedItem(const char* name)
+    : MenuItem(name), _serial(num_live++) {}
+
+    ~CountedItem() {
+        destroyed_in_order &= _serial == --num_live;
+    }
+
+private:
+    uint32_t _serial;
+};
+
+class CountedValue : public NumericMenuItem {
+public:
+    CountedValue(const char* name, float value, float min_value,
+                 float max_value)
+    : NumericMenuItem(name, value, min_value, max_value),
+      _serial(num_live++) {}
+
+    ~CountedValue() {
+        destroyed_in_order &= _serial == --num_live;
+    }
+
+private:
+    uint32_t _serial;
+};
+
+static const size_t ARENA_SIZE = MenuArena::menu_size_of(NUM_GROUPS + 2)
+    + NUM_GROUPS * MenuArena::menu_size_of(NUM_VALUES)
+    + MenuArena::size_of<CountedItem>(2)
+    + MenuArena::size_of<CountedValue>(NUM_GROUPS * NUM_VALUES);
+
+alignas(void*) static uint8_t arena_buffer[ARENA_SIZE];
+
+// Root: Info, Group x NUM_GROUPS (Value x NUM_VALUES), About
+static Menu* build_in_arena(MenuArena& arena) {
+    Menu* p_root = arena.make_menu("Main", NUM_GROUPS + 2);
+    if (p_root == nullptr)
+        return nullptr;
+    p_root->add(arena.make<CountedItem>("Info"));
+    for (menu_index_t g = 0; g < NUM_GROUPS; ++g) {
+        Menu* p_group = arena.make_menu("Group", NUM_VALUES);
+        p_root->add(p_group);
+        for (menu_index_t v = 0; v < NUM_VALUES && p_group; ++v)
+            p_group->add(arena.make<CountedValue>("Value", 50, 0, 100));
+    }
+    p_root->add(arena.make<CountedItem>("About"));
+    return p_root;
+}
+
+// The same tree from components the caller already owns
+class HeapTree {
+public:
+    HeapTree() : _info("Info"), _about("About") {
+        for (menu_index_t g = 0; g < NUM_GROUPS; ++g) {
+            _groups.emplace_back(new Menu("Group"));
+            for (menu_index_t v = 0; v < NUM_VALUES; ++v)
+                _values.emplace_back(new CountedValue("Value", 50, 0, 100));
+        }
+    }
+
+    // Builds the tree again into new group menus
+    void rebuild(Menu& root) {
+        for (std::unique_ptr<Menu>& p_group : _groups)
+            p_group.reset(new Menu("Group"));
+        build(root);
+    }
+
+    void build(Menu& root) {
+        root.add(&_info);
+        for (menu_index_t g = 0; g < NUM_GROUPS; ++g) {
+            root.add(_groups[g].get());
+            for (menu_index_t v = 0; v < NUM_VALUES; ++v)
+                _groups[g]->add(_values[g * NUM_VALUES + v].get());
+        }
+        root.add(&_about);
+    }
+
+private:
+    CountedItem _info;
+    CountedItem _about;
+    std::vector<std::unique_ptr<Menu>> _groups;
+    std::vector<std::unique_ptr<CountedValue>> _values;
+};
+
+static bool same_tree(Menu const& a, Menu const& b) {
+    if (a.get_num_components() != b.get_num_components())
+        return false;
+    for (menu_index_t i = 0; i < a.get_num_components(); ++i) {
+        MenuComponent const* p_a = a.get_menu_component(i);
+        MenuComponent const* p_b = b.get_menu_component(i);
+        if (p_a->get_kind() != p_b->get_kind()
+            || p_a->get_parent() != &a || p_b->get_parent() != &b)
+            return false;
+        if (p_a->get_kind() == MENU_COMPONENT_MENU
+            && !same_tree(static_cast<Menu const&>(*p_a),
+                          static_cast<Menu const&>(*p_b)))
+            return false;
+    }
+    return true;
+}
+
+// Walks into every group and out again
+static bool walk(MenuSystem& ms) {
+    ms.reset();
+    bool ok = true;
+    for (menu_index_t g = 0; g < NUM_GROUPS; ++g) {
+        ms.next();
+        ms.activate();
+        while (ms.next()) {}
+        ok &= ms.get_current_menu()->get_current_component_num()
+            == NUM_VALUES - 1;
+        ok &= ms.back();
+    }
+    ms.display();
+    return ok;
+}
+
+int main() {
+    NullRenderer renderer(4);
+
+    printf("\n%u components, %u-byte arena\n",
+           2 + NUM_GROUPS * (NUM_VALUES + 1), (unsigned) ARENA_SIZE);
+    printf("%-44s %12s %12s\n", "tree", "build heap", "teardown");
+
+    // Caller-owned components, Menu::add
+    HeapTree heap_tree;
+    uint64_t allocs = bench_alloc_count();
+    std::unique_ptr<MenuSystem> p_heap_ms(new MenuSystem(renderer, "Main"));
+    heap_tree.build(p_heap_ms->get_root_menu());
+    const uint64_t heap_allocs = bench_alloc_count() - allocs;
+    bool ok = walk(*p_heap_ms);
+    const uint32_t num_heap_live = num_live;
+
+    // MenuArena on a static buffer
+    bool built = true;
+    allocs = bench_alloc_count();
+    uint64_t frees = bench_free_count();
+    uint64_t arena_allocs = 0;
+    {
+        MenuArena arena(arena_buffer, sizeof(arena_buffer));
+        Menu* p_root = build_in_arena(arena);
+        MenuSystem ms(*p_root, renderer);
+        arena_allocs = bench_alloc_count() - allocs;
+        built &= !arena.has_failed() && arena.get_used() == ARENA_SIZE
+            && same_tree(*p_root, p_heap_ms->get_root_menu())
+            && num_live == 2 * num_heap_live;
+        ok &= walk(ms);
+    }
+    built &= arena_allocs == 0 && bench_free_count() == frees
+        && num_live == num_heap_live;
+    printf("%-44s %12llu %12llu\n", "MenuArena, static buffer",
+           (unsigned long long) arena_allocs,
+           (unsigned long long) (bench_free_count() - frees));
+
+    // MenuArena on one malloc'd buffer
+    allocs = bench_alloc_count();
+    frees = bench_free_count();
+    void* p_buffer = malloc(ARENA_SIZE);
+    {
+        MenuArena arena(p_buffer, ARENA_SIZE);
+        Menu* p_root = build_in_arena(arena);
+        MenuSystem ms(*p_root, renderer);
+        arena_allocs = bench_alloc_count() - allocs;
+        built &= !arena.has_failed()
+            && same_tree(*p_root, p_heap_ms->get_root_menu());
+        ok &= walk(ms);
+    }
+    free(p_buffer);
+    built &= arena_allocs == 1 && bench_free_count() - frees == 1
+        && num_live == num_heap_live;
+    printf("%-44s %12llu %12llu\n", "MenuArena, one malloc",
+           (unsigned long long) arena_allocs,
+           (unsigned long long) (bench_free_count() - frees));
+
+    // The heap tree frees its root and child lists
+    frees = bench_free_count();
+    p_heap_ms.reset();
+    printf("%-44s %12llu %12llu\n", "caller-owned components, Menu::add",
+           (unsigned long long) heap_allocs,
+           (unsigned long long) (bench_free_count() - frees));
+
+    // One byte short: the last component is missing, nothing leaks
+    bool short_ok = false;
+    {
+        MenuArena arena(arena_buffer, ARENA_SIZE - 1);
+        Menu* p_root = build_in_arena(arena);
+        short_ok = p_root != nullptr && arena.has_failed()
+            && p_root->get_num_components() == NUM_GROUPS + 1;
+        arena.clear();
+        short_ok &= !arena.has_failed() && arena.get_used() == 0
+            && num_live == num_heap_live;
+    }
+
+    printf("%-44s %12s\n", "  arena trees match, size exact, 0 or 1 alloc",
+           built ? "yes" : "NO");
+    printf("%-44s %12s\n", "  teardown destroys all, last first",
+           destroyed_in_order ? "yes" : "NO");
+    printf("%-44s %12s\n", "  short arena fails cleanly",
+           short_ok ? "yes" : "NO");
+    ok &= built && destroyed_in_order && short_ok;
+
+    bench_header("host cost, build + teardown");
+    bench_run("new MenuSystem + Menu::add, reusing items", 100000, [&](uint64_t) {
+        MenuSystem ms(renderer, "Main");
+        heap_tree.rebuild(ms.get_root_menu());
+    });
+    bench_run("MenuArena, constructing every component", 100000, [&](uint64_t) {
+        MenuArena arena(arena_buffer, sizeof(arena_buffer));
+        MenuSystem ms(*build_in_arena(arena), renderer);
+        bench_keep(ms);
+    });
+    return ok ? 0 : 1;
+}
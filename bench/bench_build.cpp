@@ -0,0 +1,67 @@
+/*
+ * bench_build.cpp - Menu construction benchmarks.
+ *
+ * Measures the cost of populating a Menu through Menu::add, with and
+ * without reserving the child storage up front, and checks that a full
+ * menu refuses further components. Also built as bench_build_wide with
+ * MENUSYSTEM_INDEX_TYPE=uint16_t.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <vector>
+
+static const uint64_t OPS = 20000;
+
+static void bench_build(menu_index_t num_items) {
+    std::vector<MenuItem> items(num_items, MenuItem("Item"));
+
+    char name[64];
+    char title[64];
+    snprintf(title, sizeof(title), "build menu of %u items", num_items);
+    bench_header(title);
+
+    snprintf(name, sizeof(name), "add x%u", num_items);
+    bench_run(name, OPS, [&](uint64_t) {
+        Menu menu("Menu");
+        for (MenuItem& item : items)
+            menu.add(&item);
+        bench_keep(menu);
+    });
+
+    snprintf(name, sizeof(name), "reserve(%u) + add x%u", num_items, num_items);
+    bench_run(name, OPS, [&](uint64_t) {
+        Menu menu("Menu");
+        menu.reserve(num_items);
+        for (MenuItem& item : items)
+            menu.add(&item);
+        bench_keep(menu);
+    });
+}
+
+// Fills a menu to MENU_INDEX_MAX components; the next add must fail.
+static bool check_overflow() {
+    MenuItem item("Item");
+    Menu menu("Menu");
+    bool ok = true;
+    for (uint32_t i = 0; i < MENU_INDEX_MAX; ++i)
+        ok &= menu.add(&item);
+    ok &= !menu.add(&item);
+    ok &= menu.get_num_components() == MENU_INDEX_MAX;
+    printf("\n%-44s %12s\n", "add refuses component past MENU_INDEX_MAX",
+           ok ? "yes" : "NO");
+    return ok;
+}
+
+int main() {
+    bench_build(16);
+    bench_build(64);
+    bench_build(255);
+    if (MENU_INDEX_MAX >= 5000)
+        bench_build(menu_index_t(5000));
+    return check_overflow() ? 0 : 1;
+}
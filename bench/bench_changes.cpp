@@ -0,0 +1,174 @@
+/*
+ * bench_changes.cpp - The MenuChangeSet passed to the renderer.
+ *
+ * Runs a scripted session over a small menu and checks after every
+ * display that the renderer received exactly the expected MenuChange
+ * flags and previous/current component numbers: cursor moves with and
+ * without wrapping, scrolling, focus, value edits, entering and leaving a
+ * submenu, invalidate, reset, a new window height and displays with
+ * nothing to redraw. Then times display() against a full redraw.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+
+// Remembers the change set of the last display
+class RecordingRenderer : public MenuComponentRenderer {
+public:
+    RecordingRenderer() : _changes(), _visible_count(4) {}
+
+    void render(Menu const& menu, MenuChangeSet const& changes) const {
+        _changes = changes;
+        bench_keep(menu);
+    }
+
+    void render(Menu const& menu) const { bench_keep(menu); }
+    void render(MenuItem const& menu_item) const { bench_keep(menu_item); }
+    void render(BackMenuItem const& menu_item) const {
+        bench_keep(menu_item);
+    }
+    void render(NumericMenuItem const& menu_item) const {
+        bench_keep(menu_item);
+    }
+
+    uint8_t get_visible_count() const { return _visible_count; }
+    void set_visible_count(uint8_t visible_count) {
+        _visible_count = visible_count;
+    }
+
+    MenuChangeSet const& get_changes() const { return _changes; }
+
+private:
+    mutable MenuChangeSet _changes;
+    uint8_t _visible_count;
+};
+
+// Root: A, B, Value, Sub (X, Back), C, D; four lines visible
+struct Session {
+    Session()
+    : ms(renderer),
+      a("A"), b("B"), value("Value", 0, 0, 10), sub("Sub"),
+      c("C"), d("D"), x("X"), back("Back", &ms) {
+        Menu& root = ms.get_root_menu();
+        root.add(&a);
+        root.add(&b);
+        root.add(&value);
+        root.add(&sub);
+        root.add(&c);
+        root.add(&d);
+        sub.add(&x);
+        sub.add(&back);
+    }
+
+    RecordingRenderer renderer;
+    MenuSystem ms;
+    MenuItem a;
+    MenuItem b;
+    NumericMenuItem value;
+    Menu sub;
+    MenuItem c;
+    MenuItem d;
+    MenuItem x;
+    BackMenuItem back;
+};
+
+struct Step {
+    const char* name;
+    void (*action)(Session& s);
+    uint8_t changes;
+    menu_index_t previous_component_num;
+    menu_index_t current_component_num;
+};
+
+static const Step steps[] = {
+    {"first display", [](Session&) {},
+     MENU_CHANGE_MENU, 0, 0},
+    {"nothing changed", [](Session&) {},
+     MENU_CHANGE_NONE, 0, 0},
+    {"prev at the top", [](Session& s) { s.ms.prev(); },
+     MENU_CHANGE_NONE, 0, 0},
+    {"next", [](Session& s) { s.ms.next(); },
+     MENU_CHANGE_CURSOR, 0, 1},
+    {"prev", [](Session& s) { s.ms.prev(); },
+     MENU_CHANGE_CURSOR, 1, 0},
+    {"prev(loop) wraps and scrolls", [](Session& s) { s.ms.prev(true); },
+     MENU_CHANGE_CURSOR | MENU_CHANGE_SCROLL, 0, 5},
+    {"next at the bottom", [](Session& s) { s.ms.next(); },
+     MENU_CHANGE_NONE, 5, 5},
+    {"next(loop) wraps and scrolls", [](Session& s) { s.ms.next(true); },
+     MENU_CHANGE_CURSOR | MENU_CHANGE_SCROLL, 5, 0},
+    {"two nexts, one display",
+     [](Session& s) { s.ms.next(); s.ms.next(); },
+     MENU_CHANGE_CURSOR, 0, 2},
+    {"focus a value", [](Session& s) { s.ms.activate(); },
+     MENU_CHANGE_FOCUS, 2, 2},
+    {"edit the value", [](Session& s) { s.ms.next(); },
+     MENU_CHANGE_VALUE, 2, 2},
+    {"unfocus with activate", [](Session& s) { s.ms.activate(); },
+     MENU_CHANGE_FOCUS, 2, 2},
+    {"focus, edit, back",
+     [](Session& s) { s.ms.activate(); s.ms.prev(); s.ms.back(); },
+     MENU_CHANGE_FOCUS | MENU_CHANGE_VALUE, 2, 2},
+    {"enter a submenu", [](Session& s) { s.ms.next(); s.ms.activate(); },
+     MENU_CHANGE_CURSOR | MENU_CHANGE_MENU, 2, 0},
+    {"leave it with back", [](Session& s) { s.ms.back(); },
+     MENU_CHANGE_MENU, 0, 3},
+    {"leave it with BackMenuItem",
+     [](Session& s) { s.ms.activate(); s.ms.next(); s.ms.activate(); },
+     MENU_CHANGE_CURSOR | MENU_CHANGE_MENU, 3, 3},
+    {"invalidate", [](Session& s) { s.ms.invalidate(); },
+     MENU_CHANGE_MENU, 3, 3},
+    {"reset", [](Session& s) { s.ms.reset(); },
+     MENU_CHANGE_MENU, 3, 0},
+    {"taller window",
+     [](Session& s) { s.renderer.set_visible_count(6); },
+     MENU_CHANGE_MENU, 0, 0},
+    {"nothing changed again", [](Session&) {},
+     MENU_CHANGE_NONE, 0, 0},
+};
+static const size_t NUM_STEPS = sizeof(steps) / sizeof(steps[0]);
+
+int main() {
+    Session s;
+    size_t num_ok = 0;
+    for (Step const& step : steps) {
+        step.action(s);
+        s.ms.display();
+        MenuChangeSet const& changes = s.renderer.get_changes();
+        const bool ok = changes.changes == step.changes
+            && changes.previous_component_num == step.previous_component_num
+            && changes.current_component_num == step.current_component_num
+            && s.ms.get_changes() == MENU_CHANGE_NONE;
+        if (!ok) {
+            printf("  %-42s got 0x%02x %u -> %u, expected 0x%02x %u -> %u\n",
+                   step.name, changes.changes,
+                   (unsigned) changes.previous_component_num,
+                   (unsigned) changes.current_component_num, step.changes,
+                   (unsigned) step.previous_component_num,
+                   (unsigned) step.current_component_num);
+        }
+        num_ok += ok;
+    }
+    const bool value_ok = s.value.get_value() == 0;
+
+    printf("\n%u scripted displays\n", (unsigned) NUM_STEPS);
+    printf("%-44s %12s\n", "  change flags and component numbers",
+           num_ok == NUM_STEPS ? "yes" : "NO");
+    printf("%-44s %12s\n", "  value edited up and down again",
+           value_ok ? "yes" : "NO");
+
+    bench_header("host cost");
+    bench_run("next(loop) + display", 1000000, [&](uint64_t) {
+        s.ms.next(true);
+        s.ms.display();
+    });
+    bench_run("invalidate + display", 1000000, [&](uint64_t) {
+        s.ms.invalidate();
+        s.ms.display();
+    });
+    return num_ok == NUM_STEPS && value_ok ? 0 : 1;
+}
@@ -0,0 +1,193 @@
+/*
+ * bench_churn.cpp - Runtime insert/remove/move on a live menu.
+ *
+ * A "Devices" submenu the user is in gains and loses entries as devices
+ * come and go: 1000 cycles of insert, navigation, move and remove at
+ * pseudo-random positions, displayed after every step. After every step
+ * the cursor must be on the component it was on, or on a neighbour of a
+ * removed one, and the parents and current flags must be consistent, also
+ * when the menu empties and refills. Then times a churn cycle against
+ * rebuilding the menu from scratch.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <memory>
+#include <vector>
+
+static const uint32_t NUM_CYCLES = 1000;
+static const menu_index_t NUM_DEVICES = 32;
+
+static uint32_t random_state = 2463534242u;
+
+static uint32_t random_below(uint32_t limit) {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state % limit;
+}
+
+// Every child has the menu as parent, exactly the current one is flagged
+// and the window shows the cursor.
+static bool consistent(Menu const& menu) {
+    const menu_index_t current = menu.get_current_component_num();
+    if (menu.get_num_components() == 0)
+        return current == 0;
+    bool ok = current < menu.get_num_components()
+        && current >= menu.get_first_visible_num()
+        && current < menu.get_first_visible_num() + menu.get_num_visible();
+    for (menu_index_t i = 0; i < menu.get_num_components(); ++i) {
+        MenuComponent const* p_component = menu.get_menu_component(i);
+        ok &= p_component->get_parent() == &menu;
+        ok &= p_component->is_current() == (i == current);
+    }
+    return ok;
+}
+
+int main() {
+    NullRenderer renderer(4);
+    MenuSystem ms(renderer);
+    Menu devices("Devices");
+    MenuItem settings("Settings");
+    ms.get_root_menu().add(&devices);
+    ms.get_root_menu().add(&settings);
+
+    std::vector<std::unique_ptr<MenuItem>> pool;
+    std::vector<MenuItem*> detached;
+    for (menu_index_t i = 0; i < NUM_DEVICES; ++i) {
+        pool.emplace_back(new MenuItem("Device"));
+        if (i < NUM_DEVICES / 2)
+            devices.add(pool.back().get());
+        else
+            detached.push_back(pool.back().get());
+    }
+    ms.reset();
+    ms.activate();
+    ms.display();
+
+    bool ok = true;
+    uint32_t num_inserts = 0;
+    uint32_t num_removes = 0;
+    uint32_t num_moves = 0;
+    const uint64_t allocs = bench_alloc_count();
+    for (uint32_t cycle = 0; cycle < NUM_CYCLES; ++cycle) {
+        // A device appears
+        if (!detached.empty()) {
+            MenuComponent const* p_current = devices.get_current_component();
+            MenuItem* p_device = detached.back();
+            const menu_index_t num =
+                random_below(devices.get_num_components() + 1);
+            ok &= devices.insert(num, p_device);
+            detached.pop_back();
+            ok &= devices.get_current_component() == p_current
+                && devices.get_menu_component(num) == p_device
+                && consistent(devices);
+            ms.display();
+            ++num_inserts;
+        }
+
+        // The user scrolls a bit
+        for (uint32_t i = random_below(4); i > 0; --i)
+            random_below(2) ? ms.next(true) : ms.prev(true);
+
+        // Entries get reordered, e.g. sorted by signal strength
+        if (devices.get_num_components() > 1) {
+            MenuComponent const* p_current = devices.get_current_component();
+            const menu_index_t from = random_below(devices.get_num_components());
+            const menu_index_t to = random_below(devices.get_num_components());
+            MenuComponent const* p_moved = devices.get_menu_component(from);
+            ok &= devices.move(from, to);
+            ok &= devices.get_current_component() == p_current
+                && devices.get_menu_component(to) == p_moved
+                && consistent(devices);
+            ms.display();
+            ++num_moves;
+        }
+
+        // A device goes away, sometimes the one under the cursor
+        if (devices.get_num_components() > 0 && random_below(3) != 0) {
+            const menu_index_t current = devices.get_current_component_num();
+            const menu_index_t num = random_below(4) == 0 ? current
+                : random_below(devices.get_num_components());
+            MenuComponent const* p_current = devices.get_current_component();
+            MenuComponent const* p_next = num + 1 < devices.get_num_components()
+                ? devices.get_menu_component(num + 1)
+                : num > 0 ? devices.get_menu_component(num - 1) : nullptr;
+            MenuItem* p_device = static_cast<MenuItem*>(
+                const_cast<MenuComponent*>(devices.get_menu_component(num)));
+            ok &= devices.remove(p_device);
+            detached.push_back(p_device);
+            ok &= devices.get_current_component()
+                    == (num == current ? p_next : p_current)
+                && p_device->get_parent() == nullptr
+                && !p_device->is_current()
+                && consistent(devices);
+            ms.display();
+            ++num_removes;
+        }
+        ok &= ms.get_current_menu() == &devices;
+    }
+    const uint64_t churn_allocs = bench_alloc_count() - allocs;
+
+    // The first device in an empty menu the user is in gets the cursor
+    while (devices.get_num_components() > 0) {
+        detached.push_back(static_cast<MenuItem*>(
+            const_cast<MenuComponent*>(devices.get_menu_component(0))));
+        devices.remove_at(0);
+    }
+    ok &= consistent(devices);
+    for (bool use_insert : {true, false}) {
+        MenuItem* p_device = detached.back();
+        ok &= use_insert ? devices.insert(0, p_device)
+                         : devices.add(p_device);
+        ok &= devices.get_current_component() == p_device
+            && p_device->is_current() && consistent(devices);
+        ms.display();
+        ok &= devices.remove(p_device) && consistent(devices);
+    }
+    for (menu_index_t i = 0; i < NUM_DEVICES / 2; ++i) {
+        devices.add(detached.back());
+        detached.pop_back();
+    }
+    ok &= consistent(devices);
+
+    // The menu the user is in can't be removed from under them
+    ok &= !ms.get_root_menu().remove(&devices);
+    ms.back();
+    ok &= ms.get_root_menu().remove(&devices)
+        && ms.get_root_menu().get_current_component() == &settings;
+
+    printf("\n%u cycles: %u inserts, %u moves, %u removes, %llu allocs\n",
+           NUM_CYCLES, num_inserts, num_moves, num_removes,
+           (unsigned long long) churn_allocs);
+    printf("%-44s %12s\n", "  cursor and tree consistent after every step",
+           ok ? "yes" : "NO");
+
+    // Timings on a fresh live menu of NUM_DEVICES / 2 entries
+    ms.get_root_menu().insert(0, &devices);
+    ms.reset();
+    ms.activate();
+    bench_header("host cost, 16 entries");
+    bench_run("insert + remove (middle)", 1000000, [&](uint64_t) {
+        devices.insert(8, detached.back());
+        devices.remove_at(8);
+    });
+    bench_run("move (first to last and back)", 1000000, [&](uint64_t) {
+        devices.move(0, devices.get_num_components() - 1);
+        devices.move(devices.get_num_components() - 1, 0);
+    });
+    std::vector<std::unique_ptr<MenuItem>> rebuild_items;
+    for (menu_index_t i = 0; i < NUM_DEVICES / 2; ++i)
+        rebuild_items.emplace_back(new MenuItem("Device"));
+    bench_run("rebuild from scratch", 200000, [&](uint64_t) {
+        Menu rebuilt("Devices");
+        for (std::unique_ptr<MenuItem>& p_item : rebuild_items)
+            rebuilt.add(p_item.get());
+        bench_keep(rebuilt);
+    });
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+/*
+ * bench_format.cpp - NumericMenuItem formatting benchmarks.
+ *
+ * Compares rendering a numeric item through the std::string API with the
+ * caller supplied buffer API. The buffer API must not touch the heap; the
+ * benchmark exits with an error if it does, or if the built-in formatter
+ * disagrees with printf or mishandles NaN and out of range values.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "bench.h"
+
+#include <MenuFormat.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const uint64_t OPS = 1000000;
+
+static size_t format_percent(const float value, char* buffer, size_t size) {
+    size_t length = menu_format_int((int32_t) value, buffer, size);
+    if (length + 1 < size) {
+        buffer[length++] = '%';
+        buffer[length] = '\0';
+    }
+    return length;
+}
+
+static const string format_percent_string(const float value) {
+    return to_string((int) value) + "%";
+}
+
+int main() {
+    NumericMenuItem item("Brightness", 0.0, -1000.0, 1000.0, 0.25);
+    char buffer[16];
+
+    bench_header("NumericMenuItem formatting");
+
+    bench_run("get_formatted_value (built-in)", OPS, [&](uint64_t i) {
+        item.set_value(i * 0.25f);
+        bench_keep(item.get_formatted_value());
+    });
+    bench_run("format_value (built-in)", OPS, [&](uint64_t i) {
+        item.set_value(i * 0.25f);
+        item.format_value(buffer, sizeof(buffer));
+        bench_keep(buffer);
+    });
+    const uint64_t allocs = bench_alloc_count();
+    for (int i = -1000; i <= 1000; ++i) {
+        item.set_value(i * 0.25f);
+        item.format_value(buffer, sizeof(buffer));
+    }
+    const uint64_t builtin_allocs = bench_alloc_count() - allocs;
+
+    item.set_number_formatter(format_percent_string);
+    bench_run("get_formatted_value (string callback)", OPS, [&](uint64_t i) {
+        item.set_value(i % 100);
+        bench_keep(item.get_formatted_value());
+    });
+
+    item.set_value_formatter(format_percent);
+    bench_run("format_value (buffer callback)", OPS, [&](uint64_t i) {
+        item.set_value(i % 100);
+        item.format_value(buffer, sizeof(buffer));
+        bench_keep(buffer);
+    });
+    const uint64_t callback_allocs_start = bench_alloc_count();
+    for (int i = 0; i < 100; ++i) {
+        item.set_value(i);
+        item.format_value(buffer, sizeof(buffer));
+    }
+    const uint64_t callback_allocs = bench_alloc_count() - callback_allocs_start;
+
+    printf("\nheap calls while rendering with format_value: %llu built-in, "
+           "%llu callback\n", (unsigned long long) builtin_allocs,
+           (unsigned long long) callback_allocs);
+
+    // Spot check the built-in formatter against printf.
+    const float samples[] = {0.0f, 0.5f, -0.25f, 1.2f, -12.345f, 99.999f,
+                             -0.001f, 12345.67f};
+    unsigned mismatches = 0;
+    for (float sample : samples) {
+        char expected[32];
+        snprintf(expected, sizeof(expected), "%.2f", sample);
+        if (strcmp(expected, "-0.00") == 0)
+            strcpy(expected, "0.00");
+        menu_format_fixed(sample, 2, buffer, sizeof(buffer));
+        if (strcmp(buffer, expected) != 0) {
+            printf("format mismatch: %s != %s\n", buffer, expected);
+            ++mismatches;
+        }
+    }
+
+    // Values printf can't be compared with
+    menu_format_fixed(NAN, 2, buffer, sizeof(buffer));
+    mismatches += strcmp(buffer, "nan") != 0;
+    menu_format_fixed(-NAN, 2, buffer, 3);
+    mismatches += strcmp(buffer, "na") != 0;
+    menu_format_fixed(INFINITY, 0, buffer, sizeof(buffer));
+    mismatches += strcmp(buffer, "4294967295") != 0;
+    menu_format_fixed(-1e30f, 0, buffer, sizeof(buffer));
+    mismatches += strcmp(buffer, "-4294967295") != 0;
+    printf("%-44s %12s\n", "  NaN and out of range values",
+           mismatches == 0 ? "yes" : "NO");
+
+    return builtin_allocs == 0 && callback_allocs == 0 && mismatches == 0
+        ? 0 : 1;
+}
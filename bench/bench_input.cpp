@@ -0,0 +1,97 @@
+/*
+ * bench_input.cpp - Batched input processing benchmarks.
+ *
+ * Feeds bursts of rotary encoder detents to a MenuSystem one event at a
+ * time (next + display per detent, as the examples do) and as a batch
+ * through MenuSystem::process.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <vector>
+
+static const uint64_t OPS = 100000;
+static const uint8_t WIDTH = 64;
+static const uint8_t BURST = 20;
+
+static uint64_t num_on_current = 0;
+
+static void on_current(MenuComponent*) {
+    ++num_on_current;
+}
+
+struct CallbackTree {
+    explicit CallbackTree(MenuSystem& ms) : items(WIDTH, MenuItem("Item")) {
+        for (MenuItem& item : items) {
+            item.set_on_current_cb(on_current);
+            ms.get_root_menu().add(&item);
+        }
+        ms.reset();
+    }
+
+    std::vector<MenuItem> items;
+};
+
+int main() {
+    // Mostly forward with some jitter, as an encoder turned quickly.
+    MenuEvent burst[BURST];
+    for (uint8_t i = 0; i < BURST; ++i)
+        burst[i] = i % 7 == 6 ? MENU_EVENT_PREV : MENU_EVENT_NEXT;
+
+    char title[64];
+    snprintf(title, sizeof(title), "bursts of %u detents, %u items, 4 lines",
+             BURST, WIDTH);
+    bench_header(title);
+
+    NullRenderer renderer(4);
+    MenuSystem ms(renderer);
+    CallbackTree tree(ms);
+
+    uint64_t callbacks = num_on_current;
+    uint64_t renders = renderer.get_num_renders();
+    bench_run("next/prev + display per event", OPS, [&](uint64_t) {
+        for (MenuEvent event : burst) {
+            if (event == MENU_EVENT_NEXT)
+                ms.next(true);
+            else
+                ms.prev(true);
+            ms.display();
+        }
+    });
+    const uint64_t runs = OPS + OPS / 10;
+    printf("%-44s %12.1f %12.1f\n", "  on_current, renderer calls per burst",
+           double(num_on_current - callbacks) / runs,
+           double(renderer.get_num_renders() - renders) / runs);
+
+    ms.reset();
+    callbacks = num_on_current;
+    renders = renderer.get_num_renders();
+    bench_run("process(burst)", OPS, [&](uint64_t) {
+        ms.process(burst, BURST, true);
+    });
+    printf("%-44s %12.1f %12.1f\n", "  on_current, renderer calls per burst",
+           double(num_on_current - callbacks) / runs,
+           double(renderer.get_num_renders() - renders) / runs);
+
+    // Both paths must end on the same component.
+    MenuSystem ms_a(renderer);
+    MenuSystem ms_b(renderer);
+    CallbackTree tree_a(ms_a);
+    CallbackTree tree_b(ms_b);
+    MenuEvent mixed[] = {MENU_EVENT_NEXT, MENU_EVENT_NEXT, MENU_EVENT_PREV,
+                         MENU_EVENT_PREV, MENU_EVENT_PREV, MENU_EVENT_NEXT};
+    for (int round = 0; round < 50; ++round) {
+        for (MenuEvent event : mixed)
+            event == MENU_EVENT_NEXT ? ms_a.next() : ms_a.prev();
+        ms_b.process(mixed, sizeof(mixed) / sizeof(mixed[0]));
+    }
+    printf("\nsequential and batched end on the same item: %s\n",
+           ms_a.get_current_menu()->get_current_component_num()
+           == ms_b.get_current_menu()->get_current_component_num()
+           ? "yes" : "no");
+    return 0;
+}
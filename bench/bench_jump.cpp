@@ -0,0 +1,75 @@
+/*
+ * bench_jump.cpp - Direct navigation benchmarks.
+ *
+ * Reaches the last item of the deepest menu by replaying key presses and
+ * by jumping there by component, by id and by path.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+static const uint64_t OPS = 200000;
+
+static void bench_tree(uint8_t width, uint8_t depth) {
+    NullRenderer renderer;
+    MenuSystem ms(renderer);
+    BenchTree tree(ms, width, depth);
+
+    std::vector<MenuIndexEntry> index((size_t) width * depth + 1);
+    const uint16_t size = ms.build_index(index.data(), index.size());
+    const uint16_t target_id = size - 1;
+    MenuComponent const* p_target = index[target_id].component;
+
+    std::string path;
+    for (uint8_t level = 1; level < depth; ++level)
+        path += "Menu/";
+    path += "Item";
+
+    char title[64];
+    snprintf(title, sizeof(title), "width=%u depth=%u (%u components)",
+             width, depth, size);
+    bench_header(title);
+
+    auto replay = [&](uint64_t) {
+        ms.reset();
+        for (uint8_t i = 1; i < depth; ++i)
+            ms.activate();
+        for (uint8_t i = 1; i < width; ++i)
+            ms.next();
+    };
+    bench_run("reset + replay activate/next", OPS, replay);
+    Menu const* p_replay_menu = ms.get_current_menu();
+    MenuComponent const* p_replay_component =
+        p_replay_menu->get_current_component();
+
+    bench_run("jump_to(component)", OPS, [&](uint64_t i) {
+        ms.jump_to(i % 2 ? p_target : ms.get_root_menu().get_menu_component(0));
+    });
+    ms.jump_to(p_target);
+    const bool same = ms.get_current_menu() == p_replay_menu
+        && ms.get_current_menu()->get_current_component() == p_replay_component
+        && p_replay_component == p_target;
+
+    bench_run("jump_to_id(id)", OPS, [&](uint64_t i) {
+        ms.jump_to_id(i % 2 ? target_id : 1);
+    });
+    bench_run("jump_to(\"Menu/.../Item\")", OPS, [&](uint64_t i) {
+        ms.jump_to(i % 2 ? path.c_str() : "Menu");
+    });
+
+    printf("%-44s %12s\n", "  jump and replay reach the same state",
+           same ? "yes" : "no");
+}
+
+int main() {
+    bench_tree(16, 4);
+    bench_tree(64, 8);
+    bench_tree(255, 8);
+    return 0;
+}
@@ -0,0 +1,243 @@
+/*
+ * bench_lcd.cpp - Character LCD bus traffic.
+ *
+ * Drives a menu through a fixed key sequence and renders every step on a
+ * mock HD44780 that counts bus transactions, once with TextGridRenderer
+ * and once with a renderer that clears the display and rewrites it, as the
+ * lcd_nav example used to. Bus time uses the HD44780 timings: 1.52 ms for
+ * a clear, 37 us for any other command or character.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "bench.h"
+
+#include <TextGridRenderer.h>
+
+#include <stdio.h>
+#include <string.h>
+
+static const uint8_t MAX_COLUMNS = 20;
+static const uint8_t MAX_ROWS = 4;
+
+class MockLcd {
+public:
+    MockLcd(uint8_t columns, uint8_t rows)
+    : _columns(columns), _rows(rows), _column(0), _row(0),
+      _clears(0), _commands(0), _writes(0) {
+        memset(_cells, ' ', sizeof(_cells));
+    }
+
+    void clear() {
+        ++_clears;
+        memset(_cells, ' ', sizeof(_cells));
+        _column = 0;
+        _row = 0;
+    }
+
+    void set_cursor(uint8_t column, uint8_t row) {
+        ++_commands;
+        _column = column;
+        _row = row;
+    }
+
+    void write(char c) {
+        ++_writes;
+        if (_column < _columns && _row < _rows)
+            _cells[_row][_column] = c;
+        ++_column;
+    }
+
+    bool same_cells(MockLcd const& other) const {
+        return memcmp(_cells, other._cells, sizeof(_cells)) == 0;
+    }
+
+    uint64_t get_transactions() const {
+        return _clears + _commands + _writes;
+    }
+
+    double get_bus_us() const {
+        return _clears * 1520.0 + (_commands + _writes) * 37.0;
+    }
+
+private:
+    uint8_t _columns;
+    uint8_t _rows;
+    uint8_t _column;
+    uint8_t _row;
+    char _cells[MAX_ROWS][MAX_COLUMNS];
+    uint64_t _clears;
+    uint64_t _commands;
+    uint64_t _writes;
+};
+
+class MockLcdRenderer : public TextGridRenderer {
+public:
+    MockLcdRenderer(MockLcd& lcd, uint8_t columns, uint8_t rows)
+    : TextGridRenderer(columns, rows), _lcd(lcd) {}
+
+protected:
+    void set_cursor(uint8_t column, uint8_t row) const {
+        _lcd.set_cursor(column, row);
+    }
+
+    void print(const char* text, uint8_t length) const {
+        while (length--)
+            _lcd.write(*text++);
+    }
+
+private:
+    MockLcd& _lcd;
+};
+
+// Same layout as TextGridRenderer, drawn after clearing the display.
+class ClearingRenderer : public MenuComponentRenderer {
+public:
+    ClearingRenderer(MockLcd& lcd, uint8_t columns, uint8_t rows)
+    : _lcd(lcd), _columns(columns), _rows(rows), _row(0), _in_menu(false) {}
+
+    uint8_t get_visible_count() const { return _rows; }
+
+    using MenuComponentRenderer::render;
+
+    void render(Menu const& menu) const {
+        if (_in_menu) {
+            print(menu.get_name());
+            return;
+        }
+        _lcd.clear();
+        _in_menu = true;
+        for (menu_index_t i = 0; i < menu.get_num_visible(); ++i) {
+            MenuComponent const* p_component = menu.get_visible_component(i);
+            _row = i;
+            _lcd.set_cursor(0, _row);
+            if (p_component != menu.get_current_component())
+                _lcd.set_cursor(1, _row);
+            else
+                _lcd.write(p_component->is_active() ? '*' : '>');
+            p_component->render(*this);
+        }
+        _in_menu = false;
+    }
+
+    void render(MenuItem const& menu_item) const {
+        print(menu_item.get_name());
+    }
+
+    void render(BackMenuItem const& menu_item) const {
+        print(menu_item.get_name());
+    }
+
+    void render(NumericMenuItem const& menu_item) const {
+        print(menu_item.get_name());
+        char buffer[16];
+        const size_t length = menu_item.format_value(buffer, sizeof(buffer));
+        _lcd.set_cursor(_columns - length, _row);
+        print(buffer);
+    }
+
+private:
+    void print(const char* text) const {
+        for (; *text != '\0'; ++text)
+            _lcd.write(*text);
+    }
+
+    MockLcd& _lcd;
+    uint8_t _columns;
+    uint8_t _rows;
+    mutable uint8_t _row;
+    mutable bool _in_menu;
+};
+
+// next x7, enter the numeric item, +5, leave, into the submenu and out.
+static const MenuEvent KEYS[] = {
+    MENU_EVENT_NEXT, MENU_EVENT_NEXT, MENU_EVENT_NEXT, MENU_EVENT_NEXT,
+    MENU_EVENT_NEXT, MENU_EVENT_NEXT, MENU_EVENT_NEXT,
+    MENU_EVENT_PREV, MENU_EVENT_PREV,
+    MENU_EVENT_ACTIVATE, MENU_EVENT_NEXT, MENU_EVENT_NEXT, MENU_EVENT_NEXT,
+    MENU_EVENT_NEXT, MENU_EVENT_NEXT, MENU_EVENT_ACTIVATE,
+    MENU_EVENT_NEXT, MENU_EVENT_ACTIVATE, MENU_EVENT_NEXT, MENU_EVENT_NEXT,
+    MENU_EVENT_BACK, MENU_EVENT_PREV, MENU_EVENT_PREV,
+};
+static const size_t NUM_KEYS = sizeof(KEYS) / sizeof(KEYS[0]);
+
+static void press(MenuSystem& ms, MenuEvent key) {
+    switch (key) {
+    case MENU_EVENT_NEXT: ms.next(true); break;
+    case MENU_EVENT_PREV: ms.prev(true); break;
+    case MENU_EVENT_ACTIVATE: ms.activate(); break;
+    case MENU_EVENT_BACK: ms.back(); break;
+    case MENU_EVENT_RESET: ms.reset(); break;
+    }
+}
+
+static bool bench_lcd(uint8_t columns, uint8_t rows) {
+    MenuSystem ms;
+    MenuItem items[] = {
+        MenuItem("Brightness"), MenuItem("Contrast"), MenuItem("Sound"),
+        MenuItem("Language"), MenuItem("Clock")
+    };
+    NumericMenuItem volume("Volume", 50, 0, 100, 1);
+    Menu network("Network");
+    MenuItem network_items[] = {
+        MenuItem("Address"), MenuItem("Gateway"), MenuItem("DNS")
+    };
+    ms.get_root_menu().add(&items[0]);
+    ms.get_root_menu().add(&items[1]);
+    ms.get_root_menu().add(&volume);
+    ms.get_root_menu().add(&network);
+    for (MenuItem& item : network_items)
+        network.add(&item);
+    for (size_t i = 2; i < sizeof(items) / sizeof(items[0]); ++i)
+        ms.get_root_menu().add(&items[i]);
+    ms.reset();
+
+    MockLcd grid_lcd(columns, rows);
+    MockLcd clearing_lcd(columns, rows);
+    MockLcdRenderer grid(grid_lcd, columns, rows);
+    ClearingRenderer clearing(clearing_lcd, columns, rows);
+
+    // Both screens must show the same text after every key
+    bool ok = true;
+    ms.display(grid);
+    ms.display(clearing);
+    ok &= grid_lcd.same_cells(clearing_lcd);
+    const uint64_t grid_start = grid_lcd.get_transactions();
+    const double grid_start_us = grid_lcd.get_bus_us();
+    const uint64_t clearing_start = clearing_lcd.get_transactions();
+    const double clearing_start_us = clearing_lcd.get_bus_us();
+    for (size_t i = 0; i < NUM_KEYS; ++i) {
+        press(ms, KEYS[i]);
+        ms.display(grid);
+        ms.display(clearing);
+        ok &= grid_lcd.same_cells(clearing_lcd);
+    }
+
+    char title[64];
+    snprintf(title, sizeof(title), "%ux%u LCD, %u keys", columns, rows,
+             (unsigned) NUM_KEYS);
+    printf("\n%s\n", title);
+    printf("%-44s %12s %12s\n", "renderer", "bus ops/key", "bus us/key");
+    printf("%-44s %12.1f %12.1f\n", "clear + rewrite",
+           double(clearing_lcd.get_transactions() - clearing_start) / NUM_KEYS,
+           (clearing_lcd.get_bus_us() - clearing_start_us) / NUM_KEYS);
+    printf("%-44s %12.1f %12.1f\n", "TextGridRenderer",
+           double(grid_lcd.get_transactions() - grid_start) / NUM_KEYS,
+           (grid_lcd.get_bus_us() - grid_start_us) / NUM_KEYS);
+    printf("%-44s %12s\n", "  same screen contents", ok ? "yes" : "NO");
+
+    bench_header("host cost");
+    bench_run("next(loop) + display (TextGridRenderer)", 200000,
+              [&](uint64_t) {
+        ms.next(true);
+        ms.display(grid);
+    });
+    return ok;
+}
+
+int main() {
+    bool ok = bench_lcd(16, 2);
+    ok &= bench_lcd(20, 4);
+    return ok ? 0 : 1;
+}
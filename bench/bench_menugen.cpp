@@ -0,0 +1,280 @@
+/*
+ * bench_menugen.cpp - Tables generated by menugen.
+ *
+ * menus/settings.menu is compiled by menugen into settings_menu.h at build
+ * time. Checks that the generated table has the shape, names and ranges
+ * of the same tree built by hand with Menu::add, then drives both
+ * through the same pseudo-random key presses and checks after every one
+ * that they are at the same component with the same focus and values, and
+ * that they called the same callbacks in the same order.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "bench.h"
+
+#include "settings_menu.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <string>
+
+static const uint32_t NUM_KEYS = 100000;
+
+static uint32_t random_state = 2463534242u;
+
+static uint32_t random_below(uint32_t limit) {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state % limit;
+}
+
+// Callbacks of both trees append "<callback> <name>;" to their log
+static bool is_logging = true;
+static std::string table_log;
+static std::string object_log;
+
+static void log_callback(std::string& log, const char* callback,
+                         const char* name) {
+    if (!is_logging)
+        return;
+    log += callback;
+    log += ' ';
+    log += name;
+    log += ';';
+}
+
+void on_item(MenuTableSystem& ms, uint8_t node_num) {
+    log_callback(table_log, "item", ms.get_node(node_num).name);
+}
+
+void on_value(MenuTableSystem& ms, uint8_t node_num) {
+    log_callback(table_log, "value", ms.get_node(node_num).name);
+}
+
+void on_current(MenuTableSystem& ms, uint8_t node_num) {
+    log_callback(table_log, "current", ms.get_node(node_num).name);
+}
+
+static void on_object_item(MenuComponent* p_component) {
+    log_callback(object_log, "item", p_component->get_name());
+}
+
+static void on_object_value(MenuComponent* p_component) {
+    log_callback(object_log, "value", p_component->get_name());
+}
+
+static void on_object_current(MenuComponent* p_component) {
+    log_callback(object_log, "current", p_component->get_name());
+}
+
+class NullTableRenderer : public MenuTableRenderer {
+public:
+    void render(MenuTableSystem const& ms) const {
+        bench_keep(ms.get_current_node());
+    }
+};
+
+// settings.menu, built the way the examples do
+class HandTree {
+public:
+    HandTree()
+    : _renderer(4),
+      _ms(_renderer, "Main"),
+      _status("Status", on_object_item, on_object_current),
+      _output("Output", on_object_item),
+      _voltage("Voltage", 5, 0, 30, 0.5, on_object_value),
+      _current("Current", 1, 0, 5, 0.25, on_object_value),
+      _ovp("OVP", 32, 0, 33, 1, on_object_value),
+      _output_back("Back", &_ms, on_object_item),
+      _display("Display"),
+      _brightness("Brightness", 80, 10, 100, 10, nullptr, on_object_current),
+      _contrast("Contrast", 50, 0, 100, 5),
+      _colors("Colors"),
+      _red("Red", on_object_item),
+      _green("Green", on_object_item),
+      _blue("Blue", on_object_item),
+      _colors_back("Back", &_ms),
+      _display_back("Back", &_ms),
+      _network("Network"),
+      _dhcp("DHCP", on_object_item),
+      _address("Static address"),
+      _octet1("Octet 1", 192, 0, 255),
+      _octet2("Octet 2", 168, 0, 255),
+      _octet3("Octet 3", 1, 0, 255),
+      _octet4("Octet 4", 10, 0, 255),
+      _address_back("Back", &_ms),
+      _port("Port", 5025, 1, 65535, 1, on_object_value),
+      _network_back("Back", &_ms),
+      _about("About \"PSU\"", on_object_item) {
+        Menu& root = _ms.get_root_menu();
+        root.add(&_status);
+        root.add(&_output);
+        root.add(&_display);
+        root.add(&_network);
+        root.add(&_about);
+        _output.add(&_voltage);
+        _output.add(&_current);
+        _output.add(&_ovp);
+        _output.add(&_output_back);
+        _display.add(&_brightness);
+        _display.add(&_contrast);
+        _display.add(&_colors);
+        _display.add(&_display_back);
+        _colors.add(&_red);
+        _colors.add(&_green);
+        _colors.add(&_blue);
+        _colors.add(&_colors_back);
+        _network.add(&_dhcp);
+        _network.add(&_address);
+        _network.add(&_port);
+        _network.add(&_network_back);
+        _address.add(&_octet1);
+        _address.add(&_octet2);
+        _address.add(&_octet3);
+        _address.add(&_octet4);
+        _address.add(&_address_back);
+    }
+
+    MenuSystem& get_menu_system() { return _ms; }
+
+private:
+    NullRenderer _renderer;
+    MenuSystem _ms;
+    MenuItem _status;
+    Menu _output;
+    NumericMenuItem _voltage;
+    NumericMenuItem _current;
+    NumericMenuItem _ovp;
+    BackMenuItem _output_back;
+    Menu _display;
+    NumericMenuItem _brightness;
+    NumericMenuItem _contrast;
+    Menu _colors;
+    MenuItem _red;
+    MenuItem _green;
+    MenuItem _blue;
+    BackMenuItem _colors_back;
+    BackMenuItem _display_back;
+    Menu _network;
+    MenuItem _dhcp;
+    Menu _address;
+    NumericMenuItem _octet1;
+    NumericMenuItem _octet2;
+    NumericMenuItem _octet3;
+    NumericMenuItem _octet4;
+    BackMenuItem _address_back;
+    NumericMenuItem _port;
+    BackMenuItem _network_back;
+    MenuItem _about;
+};
+
+static const MenuNodeKind NODE_KINDS[] = {
+    MENU_NODE_ITEM,     // MENU_COMPONENT_ITEM
+    MENU_NODE_BACK,     // MENU_COMPONENT_BACK
+    MENU_NODE_NUMERIC,  // MENU_COMPONENT_NUMERIC
+    MENU_NODE_ITEM,     // MENU_COMPONENT_STEPPED
+    MENU_NODE_MENU,     // MENU_COMPONENT_MENU
+};
+
+// Compares the subtrees at `node_num` and `component` and maps every
+// component to its node
+static bool same_shape(MenuTable const& table, uint8_t node_num,
+                       MenuComponent const& component,
+                       std::map<MenuComponent const*, uint8_t>& node_nums) {
+    MenuNode const& node = table.nodes[node_num];
+    node_nums[&component] = node_num;
+    if (strcmp(node.name, component.get_name()) != 0
+        || node.kind != NODE_KINDS[component.get_kind()])
+        return false;
+    if (node.kind == MENU_NODE_NUMERIC) {
+        NumericMenuItem const& item =
+            static_cast<NumericMenuItem const&>(component);
+        MenuNumericRange const& range = table.ranges[node.first];
+        return range.value == item.get_value()
+            && range.min_value == item.get_min_value()
+            && range.max_value == item.get_max_value();
+    }
+    if (node.kind != MENU_NODE_MENU)
+        return true;
+    Menu const& menu = static_cast<Menu const&>(component);
+    if (node.count != menu.get_num_components())
+        return false;
+    for (uint8_t i = 0; i < node.count; ++i) {
+        if (!same_shape(table, node.first + i, *menu.get_menu_component(i),
+                        node_nums))
+            return false;
+    }
+    return true;
+}
+
+int main() {
+    HandTree hand;
+    MenuSystem& ms = hand.get_menu_system();
+    NullTableRenderer table_renderer;
+    float values[SETTINGS_NUM_VALUES];
+    MenuTableSystem tms(settings_menu(), table_renderer, values);
+
+    std::map<MenuComponent const*, uint8_t> node_nums;
+    const bool shape = same_shape(settings_menu(), 0, ms.get_root_menu(),
+                                  node_nums)
+        && settings_menu().num_nodes == node_nums.size()
+        && strcmp(tms.get_node(SETTINGS_NODE_VOLTAGE).name, "Voltage") == 0
+        && strcmp(tms.get_node(SETTINGS_NODE_ABOUT).name, "About \"PSU\"")
+           == 0;
+
+    ms.reset();
+    tms.reset();
+    uint32_t num_same = 0;
+    size_t num_callbacks = 0;
+    for (uint32_t key = 0; key < NUM_KEYS; ++key) {
+        const bool loop = random_below(2) != 0;
+        switch (random_below(key % 1000 == 999 ? 6 : 5)) {
+        case 0: ms.next(loop); tms.next(loop); break;
+        case 1: ms.prev(loop); tms.prev(loop); break;
+        case 2: ms.activate(); tms.activate(); break;
+        case 3: ms.back(); tms.back(); break;
+        case 4: ms.display(); tms.display(); break;
+        default: ms.reset(); tms.reset(); break;
+        }
+
+        MenuComponent const* p_current =
+            ms.get_current_menu()->get_current_component();
+        bool same = node_nums[ms.get_current_menu()] == tms.get_current_menu()
+            && node_nums[p_current] == tms.get_current_node()
+            && p_current->is_active() == tms.is_active()
+            && object_log == table_log;
+        num_callbacks += std::count(table_log.begin(), table_log.end(), ';');
+        object_log.clear();
+        table_log.clear();
+        for (auto const& entry : node_nums) {
+            if (entry.first->get_kind() == MENU_COMPONENT_NUMERIC) {
+                same &= static_cast<NumericMenuItem const*>(entry.first)
+                    ->get_value() == tms.get_value(entry.second);
+            }
+        }
+        num_same += same;
+    }
+
+    printf("\n%u generated nodes, %u values, %u keys\n",
+           settings_menu().num_nodes, SETTINGS_NUM_VALUES, NUM_KEYS);
+    printf("%-44s %12s\n", "  same shape as the hand-built tree",
+           shape ? "yes" : "NO");
+    printf("%-44s %12s\n", "  same navigation, values and callbacks",
+           num_same == NUM_KEYS ? "yes" : "NO");
+    printf("%-44s %12zu\n", "  callbacks compared", num_callbacks);
+    is_logging = false;
+
+    bench_header("host cost");
+    bench_run("hand-built tree next(loop)", 1000000, [&](uint64_t) {
+        ms.next(true);
+    });
+    bench_run("generated table next(loop)", 1000000, [&](uint64_t) {
+        tms.next(true);
+    });
+    return shape && num_same == NUM_KEYS ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+/*
+ * bench_navigation.cpp - Navigation hot path benchmarks.
+ *
+ * Measures MenuSystem::next/prev/activate/back/reset/display on generated
+ * trees of varying width and depth, rendering with a NullRenderer.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+
+static const uint64_t OPS = 1000000;
+
+static void bench_tree(uint8_t width, uint8_t depth) {
+    NullRenderer renderer;
+    MenuSystem ms(renderer);
+    BenchTree tree(ms, width, depth);
+
+    char name[64];
+    char title[64];
+    snprintf(title, sizeof(title), "width=%u depth=%u", width, depth);
+    bench_header(title);
+
+    snprintf(name, sizeof(name), "next(loop)");
+    bench_run(name, OPS, [&](uint64_t) { ms.next(true); });
+    ms.reset();
+
+    snprintf(name, sizeof(name), "prev(loop)");
+    bench_run(name, OPS, [&](uint64_t) { ms.prev(true); });
+    ms.reset();
+
+    snprintf(name, sizeof(name), "next(no loop, at end)");
+    for (int i = 0; i < width; ++i)
+        ms.next();
+    bench_run(name, OPS, [&](uint64_t) { ms.next(); });
+    ms.reset();
+
+    if (depth > 1) {
+        snprintf(name, sizeof(name), "activate+back (one level)");
+        bench_run(name, OPS, [&](uint64_t) {
+            ms.activate();
+            ms.back();
+        });
+        ms.reset();
+
+        snprintf(name, sizeof(name), "activate+back (to depth %u)", depth);
+        bench_run(name, OPS / depth, [&](uint64_t) {
+            for (uint8_t i = 1; i < depth; ++i)
+                ms.activate();
+            for (uint8_t i = 1; i < depth; ++i)
+                ms.back();
+        });
+        ms.reset();
+
+        snprintf(name, sizeof(name), "activate+reset (from depth %u)", depth);
+        bench_run(name, OPS / depth, [&](uint64_t) {
+            for (uint8_t i = 1; i < depth; ++i)
+                ms.activate();
+            ms.reset();
+        });
+    }
+
+    snprintf(name, sizeof(name), "reset (at root)");
+    bench_run(name, OPS, [&](uint64_t) { ms.reset(); });
+
+    const uint64_t renders = renderer.get_num_renders();
+    ms.display();
+    snprintf(name, sizeof(name), "display (%llu renderer calls)",
+             (unsigned long long) (renderer.get_num_renders() - renders));
+    bench_run(name, OPS / width, [&](uint64_t) { ms.display(); });
+}
+
+// A 4 line display: render cost no longer depends on the menu width.
+static void bench_window(uint8_t width) {
+    NullRenderer renderer(4);
+    MenuSystem ms(renderer);
+    BenchTree tree(ms, width, 1);
+
+    char title[64];
+    snprintf(title, sizeof(title), "width=%u, 4 visible lines", width);
+    bench_header(title);
+
+    ms.display();
+    const uint64_t renders = renderer.get_num_renders();
+    ms.display();
+    char name[64];
+    snprintf(name, sizeof(name), "display (%llu renderer calls)",
+             (unsigned long long) (renderer.get_num_renders() - renders));
+    bench_run(name, OPS, [&](uint64_t) { ms.display(); });
+    bench_run("next(loop) + display", OPS, [&](uint64_t) {
+        ms.next(true);
+        ms.display();
+    });
+}
+
+int main() {
+    const uint8_t widths[] = {4, 16, 64, 255};
+    const uint8_t depths[] = {1, 4, 8};
+
+    for (uint8_t depth : depths)
+        for (uint8_t width : widths)
+            bench_tree(width, depth);
+    for (uint8_t width : widths)
+        bench_window(width);
+
+    return 0;
+}
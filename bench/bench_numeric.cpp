@@ -0,0 +1,132 @@
+/*
+ * bench_numeric.cpp - Numeric menu item benchmarks.
+ *
+ * Compares next()/prev() and rendering of the float NumericMenuItem with the
+ * integer and fixed-point BasicNumericMenuItem, and shows the drift of
+ * repeated float increments. Checks that ranges and ratios at the limits
+ * of their types clamp, wrap and saturate without overflowing.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "bench.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+static const uint64_t OPS = 1000000;
+
+// Drives the item through a MenuSystem so the protected next/prev are used
+// exactly as in an application.
+template <typename Item>
+static void bench_item(const char* title, Item& item) {
+    NullRenderer renderer;
+    MenuSystem ms(renderer);
+    ms.get_root_menu().add(&item);
+    ms.reset();
+    ms.activate();
+
+    char name[64];
+    bench_header(title);
+    snprintf(name, sizeof(name), "next(loop)");
+    bench_run(name, OPS, [&](uint64_t) { ms.next(true); });
+    snprintf(name, sizeof(name), "prev(loop)");
+    bench_run(name, OPS, [&](uint64_t) { ms.prev(true); });
+    snprintf(name, sizeof(name), "next+prev (clamped)");
+    bench_run(name, OPS, [&](uint64_t) {
+        ms.next();
+        ms.prev();
+    });
+
+    char buffer[16];
+    snprintf(name, sizeof(name), "format_value");
+    bench_run(name, OPS, [&](uint64_t) {
+        ms.next(true);
+        item.format_value(buffer, sizeof(buffer));
+        bench_keep(buffer);
+    });
+}
+
+int main() {
+    NumericMenuItem float_item("Float", 0.0, -100.0, 100.0, 0.1);
+    Int16MenuItem int16_item("Int16", 0, -1000, 1000, 1);
+    Int32MenuItem int32_item("Int32", 0, -1000, 1000, 1);
+    BasicNumericMenuItem<MenuQ8_8> q8_8_item("Q8.8", MenuQ8_8::ratio(0),
+        MenuQ8_8::ratio(-100), MenuQ8_8::ratio(100), MenuQ8_8::ratio(1, 10));
+    BasicNumericMenuItem<MenuFixed<int16_t, 10> > deci_item("Deci",
+        {0}, {-1000}, {1000}, {1});
+
+    bench_item("NumericMenuItem (float, step 0.1)", float_item);
+    bench_item("Int16MenuItem (step 1)", int16_item);
+    bench_item("Int32MenuItem (step 1)", int32_item);
+    bench_item("BasicNumericMenuItem<MenuQ8_8> (step 0.1)", q8_8_item);
+    bench_item("BasicNumericMenuItem<MenuFixed<int16_t, 10>> (step 0.1)",
+               deci_item);
+
+    // Ten increments of 0.1 starting from 0
+    NumericMenuItem float_drift("Float", 0.0, 0.0, 10.0, 0.1);
+    BasicNumericMenuItem<MenuFixed<int16_t, 10> > deci_drift("Deci",
+        {0}, {0}, {100}, {1});
+    NullRenderer renderer;
+    MenuSystem ms(renderer);
+    ms.get_root_menu().add(&float_drift);
+    ms.get_root_menu().add(&deci_drift);
+    ms.reset();
+    ms.activate();
+    for (int i = 0; i < 10; ++i)
+        ms.next();
+    ms.back();
+    ms.next();
+    ms.activate();
+    for (int i = 0; i < 10; ++i)
+        ms.next();
+
+    char buffer[16];
+    deci_drift.format_value(buffer, sizeof(buffer));
+    printf("\n0.1 stepped 10 times: float %.9g (== 1.0: %s), "
+           "MenuFixed<int16_t, 10> %s (== 1.0: %s)\n",
+           float_drift.get_value(),
+           float_drift.get_value() == 1.0f ? "yes" : "no",
+           buffer, deci_drift.get_value().raw == 10 ? "yes" : "no");
+
+    // Ranges ending at the limits of their type
+    Int16MenuItem int16_edge("Int16", 32760, 32700, INT16_MAX, 5);
+    Int32MenuItem int32_edge("Int32", 0, INT32_MIN, INT32_MAX, 65536);
+    MenuSystem edge_ms(renderer);
+    edge_ms.get_root_menu().add(&int16_edge);
+    edge_ms.get_root_menu().add(&int32_edge);
+    edge_ms.reset();
+    edge_ms.activate();
+    for (int i = 0; i < 20; ++i)
+        edge_ms.next();
+    bool edges = int16_edge.get_value() == 32765
+        && int16_edge.get_max_value() == 32765;
+    edge_ms.next(true);
+    edges &= int16_edge.get_value() == 32700;
+    edge_ms.back();
+    edge_ms.next();
+    edge_ms.activate();
+    edges &= int32_edge.get_value() == 0
+        && int32_edge.get_num_steps() == UINT16_MAX
+        && int32_edge.get_max_value() == INT32_MAX - 65535;
+    edge_ms.prev(true);
+    edges &= int32_edge.get_value() == -65536;
+    int32_edge.set_value(INT32_MIN);
+    edge_ms.prev(true);
+    edges &= int32_edge.get_value() == INT32_MAX - 65535;
+    edge_ms.next(true);
+    edges &= int32_edge.get_value() == INT32_MIN;
+
+    // ratio saturates instead of overflowing
+    volatile int32_t large = 40000;
+    edges &= MenuQ8_8::ratio(200).raw == INT16_MAX
+        && MenuQ8_8::ratio(-200).raw == INT16_MIN
+        && MenuQ16_16::ratio(large).raw == INT32_MAX
+        && MenuQ16_16::ratio(-large).raw == INT32_MIN
+        && MenuQ16_16::ratio(-32768).raw == INT32_MIN
+        && MenuQ16_16::ratio(3, 2).raw == 98304;
+    printf("ranges and ratios at the type limits: %s\n",
+           edges ? "yes" : "NO");
+    return edges ? 0 : 1;
+}
@@ -0,0 +1,312 @@
+/*
+ * bench_queue.cpp - Lock-free event queue stress test.
+ *
+ * A producer thread hammers a MenuEventQueue while the main thread
+ * consumes it, as an encoder ISR and the UI loop would. Checks that every
+ * event arrives once and in order, that draining into a MenuSystem with a
+ * slow renderer ends on the cursor position the events add up to, that
+ * events wrapping around the end of the buffer are displayed once, and that
+ * a producer which can't wait accounts for every dropped event. Also
+ * checks the capacity given small and empty buffers.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "bench.h"
+
+#include <MenuEventQueue.h>
+
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+static const uint32_t NUM_EVENTS = 5000000;
+static const uint8_t QUEUE_SIZE = 64;
+static const menu_index_t NUM_ITEMS = 10;
+
+// Deterministic event stream, replayed by the consumer to check the order
+class EventStream {
+public:
+    explicit EventStream(uint32_t seed=2463534242u) : _state(seed) {}
+
+    MenuEvent next(uint8_t num_kinds) {
+        _state ^= _state << 13;
+        _state ^= _state >> 17;
+        _state ^= _state << 5;
+        return MenuEvent(_state % num_kinds);
+    }
+
+private:
+    uint32_t _state;
+};
+
+class SlowRenderer : public NullRenderer {
+public:
+    explicit SlowRenderer(uint32_t render_us) : _render_us(render_us) {}
+
+    void render(Menu const& menu) const {
+        const auto until = std::chrono::steady_clock::now()
+            + std::chrono::microseconds(_render_us);
+        while (std::chrono::steady_clock::now() < until) {}
+        NullRenderer::render(menu);
+    }
+
+private:
+    uint32_t _render_us;
+};
+
+// Counts the displays of a menu of items
+class CountingRenderer : public NullRenderer {
+public:
+    CountingRenderer() : _num_displays(0) {}
+
+    void render(Menu const& menu) const {
+        ++_num_displays;
+        NullRenderer::render(menu);
+    }
+
+    uint32_t get_num_displays() const { return _num_displays; }
+
+private:
+    mutable uint32_t _num_displays;
+};
+
+static uint32_t num_on_current = 0;
+
+static void on_current(MenuComponent*) {
+    ++num_on_current;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+static void check(bool& ok, const char* name, bool result) {
+    printf("%-44s %12s\n", name, result ? "yes" : "NO");
+    ok &= result;
+}
+
+static bool check_order() {
+    MenuEvent buffer[QUEUE_SIZE];
+    MenuEventQueue queue(buffer, QUEUE_SIZE);
+    uint64_t num_full = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::thread producer([&] {
+        EventStream stream;
+        for (uint32_t i = 0; i < NUM_EVENTS; ++i) {
+            const MenuEvent event = stream.next(5);
+            while (!queue.push(event)) {
+                ++num_full;
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    EventStream expected;
+    uint32_t num_received = 0;
+    uint32_t num_wrong = 0;
+    MenuEvent events[16];
+    while (num_received < NUM_EVENTS) {
+        const uint8_t num = queue.pop(events, 16);
+        for (uint8_t i = 0; i < num; ++i)
+            num_wrong += events[i] != expected.next(5);
+        num_received += num;
+        // Let the producer run on a single core
+        if (num == 0)
+            std::this_thread::yield();
+    }
+    producer.join();
+    const double seconds = seconds_since(start);
+
+    printf("\npush/pop, capacity %u, %u events\n", queue.get_capacity(),
+           NUM_EVENTS);
+    printf("%-44s %12.1f\n", "throughput (M events/s)",
+           NUM_EVENTS / seconds / 1e6);
+    printf("%-44s %12llu\n", "producer retries on a full queue",
+           (unsigned long long) num_full);
+    bool ok = true;
+    check(ok, "every event received once, in order",
+          num_received == NUM_EVENTS && num_wrong == 0
+          && queue.get_size() == 0);
+    return ok;
+}
+
+static bool check_drain() {
+    SlowRenderer renderer(20);
+    MenuSystem ms(renderer);
+    MenuItem items[NUM_ITEMS] = {
+        MenuItem("0"), MenuItem("1"), MenuItem("2"), MenuItem("3"),
+        MenuItem("4"), MenuItem("5"), MenuItem("6"), MenuItem("7"),
+        MenuItem("8"), MenuItem("9")};
+    for (MenuItem& item : items)
+        ms.get_root_menu().add(&item);
+    ms.reset();
+    ms.display();
+
+    MenuEvent buffer[QUEUE_SIZE];
+    MenuEventQueue queue(buffer, QUEUE_SIZE);
+    std::atomic<bool> done(false);
+    const uint32_t num_events = NUM_EVENTS / 10;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::thread producer([&] {
+        // Only next and prev, so the end position is known
+        EventStream stream;
+        for (uint32_t i = 0; i < num_events; ++i) {
+            const MenuEvent event = stream.next(2);
+            while (!queue.push(event))
+                std::this_thread::yield();
+        }
+        done = true;
+    });
+
+    uint32_t num_displays = 0;
+    while (!done || queue.get_size() > 0) {
+        if (queue.get_size() == 0)
+            std::this_thread::yield();
+        num_displays += queue.drain(ms, true);
+    }
+    producer.join();
+    const double seconds = seconds_since(start);
+
+    EventStream stream;
+    int32_t position = 0;
+    for (uint32_t i = 0; i < num_events; ++i)
+        position += stream.next(2) == MENU_EVENT_NEXT ? 1 : -1;
+    position = ((position % NUM_ITEMS) + NUM_ITEMS) % NUM_ITEMS;
+
+    printf("\ndrain into MenuSystem, 20 us render, %u events\n", num_events);
+    printf("%-44s %12.1f\n", "throughput (M events/s)",
+           num_events / seconds / 1e6);
+    printf("%-44s %12u\n", "displays", num_displays);
+    bool ok = true;
+    check(ok, "cursor where the events add up to",
+          ms.get_current_menu()->get_current_component_num()
+          == menu_index_t(position));
+    return ok;
+}
+
+static bool check_wrap() {
+    CountingRenderer renderer;
+    MenuSystem ms(renderer);
+    MenuItem items[NUM_ITEMS] = {
+        MenuItem("0", nullptr, on_current), MenuItem("1", nullptr, on_current),
+        MenuItem("2", nullptr, on_current), MenuItem("3", nullptr, on_current),
+        MenuItem("4", nullptr, on_current), MenuItem("5", nullptr, on_current),
+        MenuItem("6", nullptr, on_current), MenuItem("7", nullptr, on_current),
+        MenuItem("8", nullptr, on_current), MenuItem("9", nullptr, on_current)};
+    for (MenuItem& item : items)
+        ms.get_root_menu().add(&item);
+    ms.reset();
+    ms.display();
+
+    // Move the tail near the end so the next events wrap around
+    MenuEvent buffer[8];
+    MenuEventQueue queue(buffer, 8);
+    MenuEvent events[6];
+    for (uint8_t i = 0; i < 6; ++i)
+        queue.push(MENU_EVENT_RESET);
+    queue.pop(events, 6);
+    for (uint8_t i = 0; i < 5; ++i)
+        queue.push(MENU_EVENT_NEXT);
+
+    const uint32_t num_displays = renderer.get_num_displays();
+    num_on_current = 0;
+    const bool displayed = queue.drain(ms);
+
+    printf("\ndrain across the end of the buffer, 5 events\n");
+    bool ok = true;
+    check(ok, "one display, moves coalesced",
+          displayed && renderer.get_num_displays() == num_displays + 1
+          && num_on_current == 1
+          && ms.get_current_menu()->get_current_component_num() == 5
+          && queue.get_size() == 0);
+    return ok;
+}
+
+static bool check_drop() {
+    MenuEvent buffer[QUEUE_SIZE];
+    MenuEventQueue queue(buffer, QUEUE_SIZE);
+    std::atomic<bool> done(false);
+    const uint32_t num_events = 50000;
+    uint32_t num_pushed = 0;
+
+    // An ISR can't wait for room: it pushes and moves on
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < num_events; ++i)
+            num_pushed += queue.push(MENU_EVENT_NEXT);
+        done = true;
+    });
+
+    uint32_t num_received = 0;
+    MenuEvent events[4];
+    while (!done || queue.get_size() > 0) {
+        num_received += queue.pop(events, 4);
+        std::this_thread::yield();
+    }
+    producer.join();
+
+    printf("\nproducer never waits, %u events\n", num_events);
+    printf("%-44s %12u\n", "received", num_received);
+    printf("%-44s %12u\n", "dropped", queue.get_num_dropped());
+    bool ok = true;
+    check(ok, "received + dropped == pushed",
+          num_received == num_pushed
+          && uint16_t(num_events - num_pushed) == queue.get_num_dropped());
+    return ok;
+}
+
+static bool check_sizes() {
+    // Canaries around the one slot a queue of size 1 may use
+    MenuEvent buffer[3] = {MENU_EVENT_RESET, MENU_EVENT_RESET,
+                           MENU_EVENT_RESET};
+    MenuEvent event;
+    bool ok = true;
+
+    MenuEventQueue empty(buffer + 1, 0);
+    MenuEventQueue missing(nullptr, QUEUE_SIZE);
+    bool refused = true;
+    for (MenuEventQueue* p_queue : {&empty, &missing}) {
+        refused &= p_queue->get_capacity() == 0
+            && !p_queue->push(MENU_EVENT_NEXT)
+            && !p_queue->push(MENU_EVENT_NEXT)
+            && p_queue->get_num_dropped() == 2
+            && p_queue->get_size() == 0 && p_queue->pop(&event, 1) == 0;
+    }
+    printf("\nbuffer sizes\n");
+    check(ok, "no buffer: capacity 0, every push dropped",
+          refused && buffer[1] == MENU_EVENT_RESET);
+
+    MenuEventQueue single(buffer + 1, 1);
+    check(ok, "size 1: capacity 1",
+          single.get_capacity() == 1 && single.push(MENU_EVENT_NEXT)
+          && !single.push(MENU_EVENT_PREV) && single.pop(&event, 1) == 1
+          && event == MENU_EVENT_NEXT && buffer[0] == MENU_EVENT_RESET
+          && buffer[2] == MENU_EVENT_RESET);
+
+    MenuEventQueue odd(buffer, 3);
+    check(ok, "size 3 rounds down to 2", odd.get_capacity() == 2);
+    return ok;
+}
+
+int main() {
+    bool ok = check_sizes();
+    ok &= check_order();
+    ok &= check_drain();
+    ok &= check_wrap();
+    ok &= check_drop();
+
+    MenuEvent buffer[QUEUE_SIZE];
+    MenuEventQueue queue(buffer, QUEUE_SIZE);
+    MenuEvent event;
+    bench_header("single thread cost");
+    bench_run("push + pop", 10000000, [&](uint64_t) {
+        queue.push(MENU_EVENT_NEXT);
+        bench_keep(queue.pop(&event, 1));
+    });
+    return ok ? 0 : 1;
+}
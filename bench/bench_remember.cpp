@@ -0,0 +1,201 @@
+/*
+ * bench_remember.cpp - Remembered cursor positions and multi-level back.
+ *
+ * An operator re-adjusts a setting near the end of a long "Settings" menu
+ * again and again, going back to the root in between. Counts the key
+ * presses per adjustment with and without Menu::set_remember_position and
+ * checks that the cursor and scroll window come back as they were left.
+ * Then unwinds a deep tree with back_to_root() and back(n), checking that
+ * no callbacks fire, and times them against repeated back() calls.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <memory>
+#include <vector>
+
+static const menu_index_t NUM_SETTINGS = 24;
+static const menu_index_t VOLUME_NUM = 19;
+static const uint32_t NUM_ADJUSTMENTS = 10;
+static const uint8_t DEPTH = 6;
+
+static uint32_t num_callbacks = 0;
+
+static void on_callback(MenuComponent*) {
+    ++num_callbacks;
+}
+
+// Root: Status, Settings (Item x VOLUME_NUM, Volume, Item ...)
+class Panel {
+public:
+    explicit Panel(bool remember)
+    : _renderer(4),
+      _ms(_renderer),
+      _status("Status"),
+      _settings("Settings"),
+      _volume("Volume", 50, 0, 100, 1),
+      _first_visible_num(0) {
+        _ms.get_root_menu().add(&_status);
+        _ms.get_root_menu().add(&_settings);
+        for (menu_index_t i = 0; i < NUM_SETTINGS; ++i) {
+            if (i == VOLUME_NUM) {
+                _settings.add(&_volume);
+                continue;
+            }
+            _items.emplace_back(new MenuItem("Item"));
+            _settings.add(_items.back().get());
+        }
+        _settings.set_remember_position(remember);
+        _ms.reset();
+        _ms.next();
+    }
+
+    // From the root, with the cursor on Settings: enter it, find Volume,
+    // turn it up one step and go back to the root. Returns the key presses.
+    uint32_t adjust(bool& ok) {
+        uint32_t presses = 0;
+        _ms.activate(); ++presses;
+        ok &= _ms.get_current_menu() == &_settings;
+        while (_settings.get_current_component() != &_volume) {
+            _ms.next(); ++presses;
+            _ms.display();
+        }
+        _ms.activate(); ++presses;
+        _ms.next(); ++presses;
+        _ms.activate(); ++presses;
+        _first_visible_num = _settings.get_first_visible_num();
+        _ms.back(); ++presses;
+        _ms.display();
+        ok &= _ms.get_current_menu() == &_ms.get_root_menu()
+            && !_volume.is_current() && !_volume.is_active();
+        return presses;
+    }
+
+    // The window the next entry into Settings shows
+    bool same_window() {
+        _ms.activate();
+        const bool same = _settings.get_first_visible_num() == _first_visible_num
+            && _settings.get_current_component() == &_volume
+            && _volume.is_current();
+        _ms.back();
+        return same;
+    }
+
+    float get_volume() const { return _volume.get_value(); }
+
+private:
+    NullRenderer _renderer;
+    MenuSystem _ms;
+    MenuItem _status;
+    Menu _settings;
+    NumericMenuItem _volume;
+    std::vector<std::unique_ptr<MenuItem>> _items;
+    menu_index_t _first_visible_num;
+};
+
+// A chain of DEPTH submenus, each with a numeric item in front
+class Chain {
+public:
+    explicit Chain(MenuSystem& ms)
+    : _ms(ms),
+      _leaf("Leaf", on_callback, on_callback) {
+        Menu* p_parent = &ms.get_root_menu();
+        for (uint8_t i = 0; i < DEPTH; ++i) {
+            _values.emplace_back(new NumericMenuItem("Value", 0, 0, 10, 1,
+                                                     on_callback,
+                                                     on_callback));
+            _menus.emplace_back(new Menu("Level", on_callback, on_callback));
+            p_parent->add(_values.back().get());
+            p_parent->add(_menus.back().get());
+            p_parent = _menus.back().get();
+        }
+        p_parent->add(&_leaf);
+        ms.reset();
+    }
+
+    // Goes to the leaf, focusing nothing
+    void descend() {
+        while (_ms.get_current_menu() != _menus.back().get()) {
+            _ms.next();
+            _ms.activate();
+        }
+    }
+
+    Menu const* get_menu(uint8_t level) const {
+        return level == 0 ? &_ms.get_root_menu() : _menus[level - 1].get();
+    }
+
+private:
+    MenuSystem& _ms;
+    std::vector<std::unique_ptr<NumericMenuItem>> _values;
+    std::vector<std::unique_ptr<Menu>> _menus;
+    MenuItem _leaf;
+};
+
+int main() {
+    bool ok = true;
+
+    printf("\n%u adjustments of item %u of %u, 4 visible\n",
+           NUM_ADJUSTMENTS, VOLUME_NUM + 1, NUM_SETTINGS);
+    printf("%-44s %12s\n", "mode", "keys/adjust");
+    for (int remember = 0; remember < 2; ++remember) {
+        Panel panel(remember != 0);
+        uint32_t first = panel.adjust(ok);
+        uint32_t presses = first;
+        for (uint32_t i = 1; i < NUM_ADJUSTMENTS; ++i)
+            presses += panel.adjust(ok);
+        ok &= panel.get_volume() == 50 + NUM_ADJUSTMENTS;
+        printf("%-44s %12.1f\n", remember ? "remember position" : "reset on back",
+               double(presses) / NUM_ADJUSTMENTS);
+        if (remember) {
+            const bool same = panel.same_window();
+            const bool fewer = presses - first
+                == (NUM_ADJUSTMENTS - 1) * 5;
+            printf("%-44s %12s\n", "  cursor and window restored on entry",
+                   same && fewer ? "yes" : "NO");
+            ok &= same && fewer;
+        }
+    }
+
+    // Unwinding without callbacks
+    NullRenderer renderer(4);
+    MenuSystem ms(renderer);
+    Chain chain(ms);
+    chain.descend();
+    num_callbacks = 0;
+    bool unwound = ms.back(2)
+        && ms.get_current_menu() == chain.get_menu(DEPTH - 2)
+        && ms.back_to_root()
+        && ms.get_current_menu() == &ms.get_root_menu()
+        && ms.get_root_menu().get_current_component() == chain.get_menu(1)
+        && !ms.back_to_root()
+        && !ms.back(3);
+    for (uint8_t level = 1; level <= DEPTH; ++level)
+        unwound &= !chain.get_menu(level)->is_active();
+    unwound &= num_callbacks == 0;
+    // A focused item counts as a level
+    ms.prev();
+    ms.activate();
+    unwound &= ms.get_root_menu().get_current_component()->is_active()
+        && ms.back(1)
+        && !ms.get_root_menu().get_current_component()->is_active();
+    printf("%-44s %12s\n", "  back(n), back_to_root() fire no callbacks",
+           unwound ? "yes" : "NO");
+    ok &= unwound;
+
+    ms.reset();
+    bench_header("host cost, 6 levels");
+    bench_run("descend + back() per level", 200000, [&](uint64_t) {
+        chain.descend();
+        while (ms.back()) {}
+    });
+    bench_run("descend + back_to_root()", 200000, [&](uint64_t) {
+        chain.descend();
+        ms.back_to_root();
+    });
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+/*
+ * bench_render.cpp - Virtual vs static dispatch rendering benchmarks.
+ *
+ * Renders the same menu with a MenuComponentRenderer (two virtual calls per
+ * component) and with a statically dispatched renderer driven by
+ * MenuSystem::display(Renderer const&) and menu_static_render.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <vector>
+
+static const uint64_t OPS = 200000;
+
+// Counts every component of the current menu through virtual dispatch.
+class VirtualCountingRenderer : public MenuComponentRenderer {
+public:
+    VirtualCountingRenderer() : _num_renders(0) {}
+
+    void render(Menu const& menu, MenuChangeSet const&) const {
+        ++_num_renders;
+        for (menu_index_t i = 0; i < menu.get_num_visible(); ++i)
+            menu.get_visible_component(i)->render(*this);
+    }
+
+    void render(Menu const& menu) const {
+        ++_num_renders;
+        bench_keep(menu);
+    }
+
+    void render(MenuItem const& menu_item) const {
+        ++_num_renders;
+        bench_keep(menu_item);
+    }
+
+    void render(BackMenuItem const& menu_item) const {
+        ++_num_renders;
+        bench_keep(menu_item);
+    }
+
+    void render(NumericMenuItem const& menu_item) const {
+        ++_num_renders;
+        bench_keep(menu_item);
+    }
+
+    uint64_t get_num_renders() const { return _num_renders; }
+
+private:
+    mutable uint64_t _num_renders;
+};
+
+// The same work as VirtualCountingRenderer without any virtual call.
+class StaticCountingRenderer {
+public:
+    StaticCountingRenderer() : _num_renders(0) {}
+
+    uint8_t get_visible_count() const { return 0; }
+
+    void render(Menu const& menu, MenuChangeSet const&) const {
+        ++_num_renders;
+        for (menu_index_t i = 0; i < menu.get_num_visible(); ++i)
+            menu_static_render(*this, *menu.get_visible_component(i));
+    }
+
+    void render(Menu const& menu) const {
+        ++_num_renders;
+        bench_keep(menu);
+    }
+
+    void render(MenuItem const& menu_item) const {
+        ++_num_renders;
+        bench_keep(menu_item);
+    }
+
+    void render(BackMenuItem const& menu_item) const {
+        ++_num_renders;
+        bench_keep(menu_item);
+    }
+
+    void render(NumericMenuItem const& menu_item) const {
+        ++_num_renders;
+        bench_keep(menu_item);
+    }
+
+    uint64_t get_num_renders() const { return _num_renders; }
+
+private:
+    mutable uint64_t _num_renders;
+};
+
+// A menu mixing every component kind, so the dispatch can't be predicted
+// from the previous component.
+class MixedMenu {
+public:
+    explicit MixedMenu(MenuSystem& ms, uint8_t width)
+    : _submenu("Submenu"),
+      _back("Back", &ms) {
+        _items.reserve(width);
+        _numerics.reserve(width);
+        Menu& root = ms.get_root_menu();
+        root.add(&_back);
+        root.add(&_submenu);
+        for (uint8_t i = 2; i < width; ++i) {
+            if (i % 2) {
+                _numerics.emplace_back("Value", i, 0, 255, 1);
+                root.add(&_numerics.back());
+            } else {
+                _items.emplace_back("Item");
+                root.add(&_items.back());
+            }
+        }
+        ms.reset();
+    }
+
+private:
+    Menu _submenu;
+    BackMenuItem _back;
+    std::vector<MenuItem> _items;
+    std::vector<NumericMenuItem> _numerics;
+};
+
+int main() {
+    const uint8_t widths[] = {4, 16, 64};
+
+    for (uint8_t width : widths) {
+        char title[64];
+        snprintf(title, sizeof(title), "render %u mixed components", width);
+        bench_header(title);
+
+        VirtualCountingRenderer renderer;
+        MenuSystem virtual_ms(renderer);
+        MixedMenu virtual_menu(virtual_ms, width);
+        bench_run("virtual dispatch (MenuComponentRenderer)", OPS,
+                  [&](uint64_t) { virtual_ms.display(); });
+
+        StaticCountingRenderer static_renderer;
+        MenuSystem static_ms;
+        MixedMenu static_menu(static_ms, width);
+        bench_run("static dispatch (menu_static_render)", OPS,
+                  [&](uint64_t) { static_ms.display(static_renderer); });
+
+        printf("%-44s %12llu %12llu\n", "  renders (virtual, static)",
+               (unsigned long long) renderer.get_num_renders(),
+               (unsigned long long) static_renderer.get_num_renders());
+    }
+    return 0;
+}
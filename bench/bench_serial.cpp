@@ -0,0 +1,211 @@
+/*
+ * bench_serial.cpp - Serial terminal output per frame.
+ *
+ * Drives a menu through a fixed key sequence and renders every step to a
+ * mock serial port counting write calls and bytes, once with a renderer
+ * writing every fragment as it goes, as the serial_nav example used to,
+ * and with TextStreamRenderer in scrolling and ANSI mode. Also checks that
+ * the buffered output matches the fragment output byte for byte, even with
+ * a buffer too small for a frame.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "bench.h"
+
+#include <TextStreamRenderer.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+static const uint8_t VISIBLE_COUNT = 6;
+
+class MockSerial {
+public:
+    MockSerial() : _num_writes(0) {}
+
+    void write(const char* data, size_t size) {
+        ++_num_writes;
+        _bytes.append(data, size);
+    }
+
+    uint64_t get_num_writes() const { return _num_writes; }
+    std::string const& get_bytes() const { return _bytes; }
+
+private:
+    uint64_t _num_writes;
+    std::string _bytes;
+};
+
+class MockSerialRenderer : public TextStreamRenderer {
+public:
+    MockSerialRenderer(MockSerial& serial, uint16_t buffer_size, bool ansi)
+    : TextStreamRenderer(buffer_size, VISIBLE_COUNT, ansi),
+      _serial(serial) {}
+
+protected:
+    void write(const char* data, uint16_t size) const {
+        _serial.write(data, size);
+    }
+
+private:
+    MockSerial& _serial;
+};
+
+// TextStreamRenderer's scrolling layout, one write per fragment.
+class FragmentRenderer : public MenuComponentRenderer {
+public:
+    explicit FragmentRenderer(MockSerial& serial)
+    : _serial(serial), _in_menu(false) {}
+
+    uint8_t get_visible_count() const { return VISIBLE_COUNT; }
+
+    using MenuComponentRenderer::render;
+
+    void render(Menu const& menu) const {
+        if (_in_menu) {
+            print(menu.get_name());
+            return;
+        }
+        print("\r\n");
+        print(menu.get_name());
+        print("\r\n");
+        _in_menu = true;
+        for (menu_index_t i = 0; i < menu.get_num_visible(); ++i) {
+            MenuComponent const* p_component = menu.get_visible_component(i);
+            p_component->render(*this);
+            if (p_component == menu.get_current_component())
+                print(" <<<");
+            print("\r\n");
+        }
+        _in_menu = false;
+    }
+
+    void render(MenuItem const& menu_item) const {
+        print(menu_item.get_name());
+    }
+
+    void render(BackMenuItem const& menu_item) const {
+        print(menu_item.get_name());
+    }
+
+    void render(NumericMenuItem const& menu_item) const {
+        char value[16];
+        menu_item.format_value(value, sizeof(value));
+        print(menu_item.get_name());
+        print(menu_item.is_active() ? "<" : "=");
+        print(value);
+        if (menu_item.is_active())
+            print(">");
+    }
+
+private:
+    void print(const char* text) const {
+        _serial.write(text, strlen(text));
+    }
+
+    MockSerial& _serial;
+    mutable bool _in_menu;
+};
+
+// next x7, enter the numeric item, +5, leave, into the submenu and out.
+static const MenuEvent KEYS[] = {
+    MENU_EVENT_NEXT, MENU_EVENT_NEXT, MENU_EVENT_NEXT, MENU_EVENT_NEXT,
+    MENU_EVENT_NEXT, MENU_EVENT_NEXT, MENU_EVENT_NEXT,
+    MENU_EVENT_PREV, MENU_EVENT_PREV,
+    MENU_EVENT_ACTIVATE, MENU_EVENT_NEXT, MENU_EVENT_NEXT, MENU_EVENT_NEXT,
+    MENU_EVENT_NEXT, MENU_EVENT_NEXT, MENU_EVENT_ACTIVATE,
+    MENU_EVENT_NEXT, MENU_EVENT_ACTIVATE, MENU_EVENT_NEXT, MENU_EVENT_NEXT,
+    MENU_EVENT_BACK, MENU_EVENT_PREV, MENU_EVENT_PREV,
+};
+static const size_t NUM_KEYS = sizeof(KEYS) / sizeof(KEYS[0]);
+
+int main() {
+    MenuSystem ms;
+    MenuItem items[] = {
+        MenuItem("Brightness"), MenuItem("Contrast"), MenuItem("Sound"),
+        MenuItem("Language"), MenuItem("Clock")
+    };
+    NumericMenuItem volume("Volume", 50, 0, 100, 1);
+    Menu network("Network");
+    MenuItem network_items[] = {
+        MenuItem("Address"), MenuItem("Gateway"), MenuItem("DNS")
+    };
+    ms.get_root_menu().add(&items[0]);
+    ms.get_root_menu().add(&items[1]);
+    ms.get_root_menu().add(&volume);
+    ms.get_root_menu().add(&network);
+    for (MenuItem& item : network_items)
+        network.add(&item);
+    for (size_t i = 2; i < sizeof(items) / sizeof(items[0]); ++i)
+        ms.get_root_menu().add(&items[i]);
+    ms.reset();
+
+    MockSerial fragment_serial;
+    MockSerial stream_serial;
+    MockSerial small_serial;
+    MockSerial ansi_serial;
+    FragmentRenderer fragment(fragment_serial);
+    MockSerialRenderer stream(stream_serial, 256, false);
+    MockSerialRenderer small(small_serial, 32, false);
+    MockSerialRenderer ansi(ansi_serial, 256, true);
+
+    const size_t num_frames = NUM_KEYS + 1;
+    for (size_t i = 0; i < num_frames; ++i) {
+        if (i > 0) {
+            switch (KEYS[i - 1]) {
+            case MENU_EVENT_NEXT: ms.next(true); break;
+            case MENU_EVENT_PREV: ms.prev(true); break;
+            case MENU_EVENT_ACTIVATE: ms.activate(); break;
+            case MENU_EVENT_BACK: ms.back(); break;
+            case MENU_EVENT_RESET: ms.reset(); break;
+            }
+        }
+        ms.display(fragment);
+        ms.display(stream);
+        ms.display(small);
+        ms.display(ansi);
+    }
+
+    printf("\n%u frames, %u visible lines\n", (unsigned) num_frames,
+           VISIBLE_COUNT);
+    printf("%-44s %12s %12s\n", "renderer", "writes/frame", "bytes/frame");
+    struct Row {
+        const char* name;
+        MockSerial const& serial;
+    };
+    const Row rows[] = {
+        {"write per fragment", fragment_serial},
+        {"TextStreamRenderer, 256 B buffer", stream_serial},
+        {"TextStreamRenderer, 32 B buffer", small_serial},
+        {"TextStreamRenderer, 256 B buffer, ANSI", ansi_serial},
+    };
+    for (Row const& row : rows) {
+        printf("%-44s %12.1f %12.1f\n", row.name,
+               double(row.serial.get_num_writes()) / num_frames,
+               double(row.serial.get_bytes().size()) / num_frames);
+    }
+
+    const bool same = stream_serial.get_bytes() == fragment_serial.get_bytes()
+        && small_serial.get_bytes() == fragment_serial.get_bytes();
+    const bool one_write = stream_serial.get_num_writes() == num_frames
+        && ansi_serial.get_num_writes() == num_frames;
+    printf("%-44s %12s\n", "  same bytes as write per fragment",
+           same ? "yes" : "NO");
+    printf("%-44s %12s\n", "  one write per frame", one_write ? "yes" : "NO");
+
+    bench_header("host cost");
+    MockSerial sink;
+    MockSerialRenderer renderer(sink, 256, true);
+    bench_run("next(loop) + display (TextStreamRenderer)", 200000,
+              [&](uint64_t i) {
+        ms.next(true);
+        ms.display(renderer);
+        // Keep the mock from growing without bound
+        if (i % 1024 == 0)
+            sink = MockSerial();
+    });
+    return same && one_write ? 0 : 1;
+}
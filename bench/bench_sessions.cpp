@@ -0,0 +1,199 @@
+/*
+ * bench_sessions.cpp - Several MenuTableSystem sessions over one table.
+ *
+ * A serial console and a front panel navigate the same constant table and
+ * share its values, with their key presses interleaved pseudo-randomly.
+ * After every press checks that each session's cursor and focus are those
+ * of a session navigating the table alone with the same presses, that
+ * only the session editing a value changed it, and that both renderers
+ * show the same values. Then compares the RAM of a second session with
+ * that of a second object tree.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "bench.h"
+
+#include <MenuTable.h>
+
+#include <stdio.h>
+#include <string.h>
+
+static const uint32_t NUM_KEYS = 200000;
+
+static uint32_t random_state = 2463534242u;
+
+static uint32_t random_below(uint32_t limit) {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state % limit;
+}
+
+constexpr MenuNumericRange ranges[] = {
+    // value, min, max, increment
+    {5, 0, 30, 0.5},
+    {1, 0, 5, 0.25},
+    {80, 10, 100, 10},
+    {50, 0, 100, 5},
+    {5025, 1, 65535, 1},
+};
+static const uint8_t NUM_VALUES = sizeof(ranges) / sizeof(ranges[0]);
+
+constexpr MenuNode nodes[] = {
+    menu_node("Main", 1, 4),
+    item_node("Status"),
+    menu_node("Output", 5, 3),
+    menu_node("Display", 8, 4),
+    menu_node("Network", 12, 2),
+    numeric_node("Voltage", 0),
+    numeric_node("Current", 1),
+    back_node("Back"),
+    numeric_node("Brightness", 2),
+    numeric_node("Contrast", 3),
+    menu_node("Colors", 14, 3),
+    back_node("Back"),
+    numeric_node("Port", 4),
+    back_node("Back"),
+    item_node("Red"),
+    item_node("Green"),
+    back_node("Back"),
+};
+static_assert(menu_nodes_valid(nodes), "invalid menu table");
+static const uint8_t NUM_NODES = sizeof(nodes) / sizeof(nodes[0]);
+static const uint8_t VOLTAGE_NODE = 5;
+
+constexpr MenuTable table = {nodes, NUM_NODES, ranges, NUM_VALUES};
+
+// Remembers the values of the numeric nodes it last rendered
+class RecordingRenderer : public MenuTableRenderer {
+public:
+    RecordingRenderer() : _values(), _is_shown() {}
+
+    void render(MenuTableSystem const& ms) const {
+        memset(_is_shown, 0, sizeof(_is_shown));
+        MenuNode const& menu = ms.get_node(ms.get_current_menu());
+        for (uint8_t i = 0; i < menu.count; ++i) {
+            const uint8_t node_num = menu.first + i;
+            if (ms.get_node(node_num).kind != MENU_NODE_NUMERIC)
+                continue;
+            _values[node_num] = ms.get_value(node_num);
+            _is_shown[node_num] = true;
+        }
+    }
+
+    bool is_shown(uint8_t node_num) const { return _is_shown[node_num]; }
+    float get_value(uint8_t node_num) const { return _values[node_num]; }
+
+private:
+    mutable float _values[NUM_NODES];
+    mutable bool _is_shown[NUM_NODES];
+};
+
+static void press(MenuTableSystem& ms, uint32_t key) {
+    switch (key) {
+    case 0: ms.next(); break;
+    case 1: ms.prev(); break;
+    case 2: ms.next(true); break;
+    case 3: ms.prev(true); break;
+    case 4: ms.activate(); break;
+    case 5: ms.back(); break;
+    default: ms.reset(); break;
+    }
+}
+
+static bool same_cursor(MenuTableSystem const& a, MenuTableSystem const& b) {
+    return a.get_current_menu() == b.get_current_menu()
+        && a.get_current_node() == b.get_current_node()
+        && a.get_depth() == b.get_depth()
+        && a.is_active() == b.is_active();
+}
+
+int main() {
+    float values[NUM_VALUES];
+    RecordingRenderer console_renderer;
+    RecordingRenderer panel_renderer;
+    MenuTableSystem console(table, console_renderer, values);
+    MenuTableSystem panel(console, panel_renderer);
+    MenuTableSystem* sessions[] = {&console, &panel};
+
+    // The same presses on sessions of their own
+    float console_alone_values[NUM_VALUES];
+    float panel_alone_values[NUM_VALUES];
+    MenuTableSystem console_alone(table, console_renderer,
+                                  console_alone_values);
+    MenuTableSystem panel_alone(table, panel_renderer, panel_alone_values);
+    MenuTableSystem* alone[] = {&console_alone, &panel_alone};
+
+    uint32_t num_isolated = 0;
+    uint32_t num_shared = 0;
+    uint32_t num_edits = 0;
+    for (uint32_t i = 0; i < NUM_KEYS; ++i) {
+        const uint32_t s = random_below(2);
+        // A press on either session, rarely a reset
+        const uint32_t key = random_below(i % 500 == 499 ? 7 : 6);
+        float before[NUM_VALUES];
+        memcpy(before, values, sizeof(values));
+        const uint8_t edited_slot = sessions[s]->is_active()
+            ? nodes[sessions[s]->get_current_node()].first : NUM_VALUES;
+
+        press(*sessions[s], key);
+        press(*alone[s], key);
+        console.display();
+        panel.display();
+
+        num_isolated += same_cursor(console, console_alone)
+            && same_cursor(panel, panel_alone);
+
+        bool shared = true;
+        for (uint8_t slot = 0; slot < NUM_VALUES; ++slot) {
+            if (values[slot] != before[slot]) {
+                shared &= slot == edited_slot;
+                ++num_edits;
+            }
+        }
+        for (uint8_t node_num = 0; node_num < NUM_NODES; ++node_num) {
+            for (RecordingRenderer const* p_renderer :
+                 {&console_renderer, &panel_renderer}) {
+                if (p_renderer->is_shown(node_num))
+                    shared &= p_renderer->get_value(node_num)
+                        == console.get_value(node_num);
+            }
+        }
+        num_shared += shared;
+    }
+
+    // A session added later leaves the values alone
+    const float voltage = console.get_value(VOLTAGE_NODE);
+    console.set_value(VOLTAGE_NODE, voltage == 10 ? 12 : 10);
+    RecordingRenderer late_renderer;
+    MenuTableSystem late(panel, late_renderer);
+    const bool kept = late.get_value(VOLTAGE_NODE)
+        == console.get_value(VOLTAGE_NODE)
+        && late.get_depth() == 0 && !late.is_active();
+
+    printf("\n2 sessions, %u nodes, %u interleaved keys, %u edits\n",
+           NUM_NODES, NUM_KEYS, num_edits);
+    printf("%-44s %12s\n", "  each cursor as if alone",
+           num_isolated == NUM_KEYS ? "yes" : "NO");
+    printf("%-44s %12s\n", "  values shared, changed by the editor only",
+           num_shared == NUM_KEYS ? "yes" : "NO");
+    printf("%-44s %12s\n", "  new session keeps the values",
+           kept ? "yes" : "NO");
+
+    const size_t object_tree = sizeof(MenuSystem) + sizeof(Menu) * 5
+        + sizeof(MenuItem) * 3 + sizeof(BackMenuItem) * 4
+        + sizeof(NumericMenuItem) * NUM_VALUES
+        + sizeof(MenuComponent*) * (NUM_NODES - 1);
+    printf("%-44s %12zu bytes\n", "RAM of a second session",
+           sizeof(MenuTableSystem));
+    printf("%-44s %12zu bytes\n", "RAM of a second object tree", object_tree);
+
+    bench_header("host cost");
+    bench_run("next(loop), sessions alternating", 1000000, [&](uint64_t i) {
+        sessions[i & 1]->next(true);
+    });
+    return num_isolated == NUM_KEYS && num_shared == NUM_KEYS && kept
+        ? 0 : 1;
+}
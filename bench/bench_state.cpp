@@ -0,0 +1,187 @@
+/*
+ * bench_state.cpp - Navigation state snapshot and restore.
+ *
+ * Saves where the user is in a small settings tree, restores it in a second
+ * MenuSystem built from scratch, as after a watchdog reset, and checks the
+ * cursor, the focus and the callbacks fired, and that a focus bit on a
+ * plain item is ignored. Then times restore_state against replaying the
+ * key presses at growing depths.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const uint64_t OPS = 200000;
+
+static uint32_t num_callbacks = 0;
+
+static void on_callback(MenuComponent*) {
+    ++num_callbacks;
+}
+
+// Root: Info, Settings (Display (Brightness, Contrast), Sound), About
+class Device {
+public:
+    Device()
+    : _info("Info", on_callback, on_callback),
+      _settings("Settings", on_callback, on_callback),
+      _display("Display", on_callback, on_callback),
+      _brightness("Brightness", 50, 0, 100, 1, on_callback, on_callback),
+      _contrast("Contrast", 50, 0, 100, 1, on_callback, on_callback),
+      _sound("Sound", on_callback, on_callback),
+      _about("About", on_callback, on_callback) {
+        _ms.get_root_menu().add(&_info);
+        _ms.get_root_menu().add(&_settings);
+        _ms.get_root_menu().add(&_about);
+        _settings.add(&_display);
+        _settings.add(&_sound);
+        _display.add(&_brightness);
+        _display.add(&_contrast);
+        _ms.reset();
+    }
+
+    MenuSystem& get_menu_system() { return _ms; }
+
+    char const* get_current_name() const {
+        return _ms.get_current_menu()->get_current_component()->get_name();
+    }
+
+    bool is_focused() const {
+        return _ms.get_current_menu()->get_current_component()->is_active();
+    }
+
+private:
+    MenuSystem _ms;
+    MenuItem _info;
+    Menu _settings;
+    Menu _display;
+    NumericMenuItem _brightness;
+    NumericMenuItem _contrast;
+    MenuItem _sound;
+    MenuItem _about;
+};
+
+static void check(bool& ok, const char* name, bool result) {
+    printf("%-44s %12s\n", name, result ? "yes" : "NO");
+    ok &= result;
+}
+
+static bool check_restore() {
+    bool ok = true;
+    uint8_t state[MENUSYSTEM_STATE_SIZE];
+
+    // Settings > Display > Contrast, being edited
+    Device before;
+    MenuSystem& ms = before.get_menu_system();
+    ms.next();
+    ms.activate();
+    ms.activate();
+    ms.next();
+    ms.activate();
+    const uint8_t size = ms.save_state(state, sizeof(state));
+    printf("\nstate of %s (focused) at depth 3: %u bytes\n",
+           before.get_current_name(), size);
+
+    Device after;
+    num_callbacks = 0;
+    const bool restored = after.get_menu_system().restore_state(state, size);
+    check(ok, "restored to the same component",
+          restored && strcmp(after.get_current_name(), "Contrast") == 0
+          && after.get_menu_system().get_current_menu()->get_parent()
+             ->get_current_component()->is_active());
+    check(ok, "focus restored", after.is_focused());
+    check(ok, "no callbacks fired", num_callbacks == 0);
+
+    // The restored state behaves like the navigated one
+    after.get_menu_system().back();
+    after.get_menu_system().back();
+    check(ok, "back leaves focus, then Display",
+          strcmp(after.get_current_name(), "Display") == 0);
+
+    Device notified;
+    num_callbacks = 0;
+    notified.get_menu_system().restore_state(state, size, true);
+    check(ok, "notify fires only the target's on_current",
+          num_callbacks == 1);
+
+    check(ok, "truncated state refused",
+          !notified.get_menu_system().restore_state(state, size - 1));
+    uint8_t stale[MENUSYSTEM_STATE_SIZE];
+    memcpy(stale, state, size);
+    stale[1 + sizeof(menu_index_t)] = 7;
+    check(ok, "state of another tree refused, cursor kept",
+          !notified.get_menu_system().restore_state(stale, size)
+          && strcmp(notified.get_current_name(), "Contrast") == 0);
+
+    // Settings > Sound with the focus bit set, as a corrupted or hand
+    // written state could have it
+    Device plain;
+    MenuSystem& plain_ms = plain.get_menu_system();
+    plain_ms.next();
+    plain_ms.activate();
+    plain_ms.next();
+    uint8_t focused[MENUSYSTEM_STATE_SIZE];
+    const uint8_t focused_size = plain_ms.save_state(focused,
+                                                     sizeof(focused));
+    focused[0] |= 0x80;
+    Device restored_plain;
+    MenuSystem& restored_ms = restored_plain.get_menu_system();
+    check(ok, "focus on a plain item ignored",
+          restored_ms.restore_state(focused, focused_size)
+          && strcmp(restored_plain.get_current_name(), "Sound") == 0
+          && !restored_plain.is_focused() && restored_ms.prev()
+          && strcmp(restored_plain.get_current_name(), "Display") == 0);
+
+    uint8_t small[2];
+    check(ok, "buffer too small refused",
+          ms.save_state(small, sizeof(small)) == 0);
+    return ok;
+}
+
+static void bench_depth(uint8_t depth) {
+    NullRenderer renderer;
+    MenuSystem ms(renderer);
+    const uint8_t width = 16;
+    BenchTree tree(ms, width, depth);
+
+    // The last item of the deepest menu
+    for (uint8_t i = 1; i < depth; ++i)
+        ms.activate();
+    for (uint8_t i = 1; i < width; ++i)
+        ms.next();
+    uint8_t state[MENUSYSTEM_STATE_SIZE];
+    const uint8_t size = ms.save_state(state, sizeof(state));
+
+    char title[64];
+    snprintf(title, sizeof(title), "width=%u depth=%u (%u byte state)",
+             width, depth, size);
+    bench_header(title);
+    bench_run("reset + replay activate/next", OPS, [&](uint64_t) {
+        ms.reset();
+        for (uint8_t i = 1; i < depth; ++i)
+            ms.activate();
+        for (uint8_t i = 1; i < width; ++i)
+            ms.next();
+    });
+    bench_run("save_state", OPS, [&](uint64_t) {
+        bench_keep(ms.save_state(state, sizeof(state)));
+    });
+    bench_run("reset + restore_state", OPS, [&](uint64_t) {
+        ms.reset();
+        ms.restore_state(state, size);
+    });
+}
+
+int main() {
+    const bool ok = check_restore();
+    bench_depth(2);
+    bench_depth(4);
+    bench_depth(8);
+    bench_depth(16);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,183 @@
+/*
+ * bench_stats.cpp - MENUSYSTEM_STATS counters and timings.
+ *
+ * Built twice: bench_stats without MENUSYSTEM_STATS and bench_stats_enabled
+ * with it, so the navigation cost of both builds can be compared. The
+ * enabled build drives a menu through a fixed key sequence with a fake
+ * clock that the renderer and the callbacks advance, checks every counter
+ * and time against what the renderer and callbacks saw, and dumps them.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+
+static const uint32_t RENDER_TICKS = 100;
+static const uint32_t CALLBACK_TICKS = 7;
+
+static uint32_t fake_clock = 0;
+static uint32_t num_on_activate = 0;
+static uint32_t num_on_current = 0;
+
+#ifdef MENUSYSTEM_STATS
+static uint32_t fake_now() {
+    return fake_clock;
+}
+#endif
+
+static void on_activate(MenuComponent*) {
+    ++num_on_activate;
+    fake_clock += CALLBACK_TICKS;
+}
+
+static void on_current(MenuComponent*) {
+    ++num_on_current;
+    fake_clock += CALLBACK_TICKS;
+}
+
+// Lists the visible components and counts what it rendered
+class CountingRenderer : public MenuComponentRenderer {
+public:
+    CountingRenderer() : _num_renders(), _in_menu(false) {}
+
+    uint8_t get_visible_count() const { return 4; }
+
+    using MenuComponentRenderer::render;
+
+    void render(Menu const& menu) const {
+        if (_in_menu) {
+            ++_num_renders[MENU_COMPONENT_MENU];
+            return;
+        }
+        fake_clock += RENDER_TICKS;
+        _in_menu = true;
+        for (menu_index_t i = 0; i < menu.get_num_visible(); ++i)
+            menu.get_visible_component(i)->render(*this);
+        _in_menu = false;
+    }
+
+    void render(MenuItem const&) const {
+        ++_num_renders[MENU_COMPONENT_ITEM];
+    }
+
+    void render(BackMenuItem const&) const {
+        ++_num_renders[MENU_COMPONENT_BACK];
+    }
+
+    void render(NumericMenuItem const&) const {
+        ++_num_renders[MENU_COMPONENT_NUMERIC];
+    }
+
+    void render(SteppedMenuItem const&) const {
+        ++_num_renders[MENU_COMPONENT_STEPPED];
+    }
+
+    uint32_t get_num_renders(MenuComponentKind kind) const {
+        return _num_renders[kind];
+    }
+
+private:
+    mutable uint32_t _num_renders[MENU_COMPONENT_MENU + 1];
+    mutable bool _in_menu;
+};
+
+// next x3, edit the numeric item, into the submenu and out, then a batch.
+static const MenuEvent KEYS[] = {
+    MENU_EVENT_NEXT, MENU_EVENT_NEXT, MENU_EVENT_NEXT, MENU_EVENT_PREV,
+    MENU_EVENT_ACTIVATE, MENU_EVENT_NEXT, MENU_EVENT_NEXT,
+    MENU_EVENT_ACTIVATE, MENU_EVENT_NEXT, MENU_EVENT_ACTIVATE,
+    MENU_EVENT_NEXT, MENU_EVENT_BACK, MENU_EVENT_RESET,
+};
+static const size_t NUM_KEYS = sizeof(KEYS) / sizeof(KEYS[0]);
+
+static const MenuEvent BATCH[] = {
+    MENU_EVENT_NEXT, MENU_EVENT_NEXT, MENU_EVENT_NEXT, MENU_EVENT_PREV,
+};
+
+int main() {
+    CountingRenderer renderer;
+    MenuSystem ms(renderer);
+    MenuItem info("Info", on_activate, on_current);
+    MenuItem clock("Clock", on_activate, on_current);
+    NumericMenuItem volume("Volume", 50, 0, 100, 1, on_activate, on_current);
+    Menu network("Network", on_activate, on_current);
+    BackMenuItem network_back("Back", &ms, on_activate, on_current);
+    Int16MenuItem port("Port", 80, 1, 1024, 1, on_activate, on_current);
+    MenuItem about("About", on_activate, on_current);
+    ms.get_root_menu().add(&info);
+    ms.get_root_menu().add(&clock);
+    ms.get_root_menu().add(&volume);
+    ms.get_root_menu().add(&network);
+    ms.get_root_menu().add(&about);
+    network.add(&network_back);
+    network.add(&port);
+    ms.reset();
+
+    bool ok = true;
+#ifdef MENUSYSTEM_STATS
+    menu_stats_clear();
+    menu_stats_set_clock(fake_now);
+    num_on_activate = 0;
+    num_on_current = 0;
+    uint32_t num_presses[MENU_EVENT_RESET + 1] = {};
+    for (size_t i = 0; i < NUM_KEYS; ++i) {
+        ++num_presses[KEYS[i]];
+        switch (KEYS[i]) {
+        case MENU_EVENT_NEXT: ms.next(); break;
+        case MENU_EVENT_PREV: ms.prev(); break;
+        case MENU_EVENT_ACTIVATE: ms.activate(); break;
+        case MENU_EVENT_BACK: ms.back(); break;
+        case MENU_EVENT_RESET: ms.reset(); break;
+        }
+        ms.display();
+    }
+    ms.process(BATCH, sizeof(BATCH) / sizeof(BATCH[0]));
+
+    printf("\nMENUSYSTEM_STATS after %u keys and a batch of %u events\n",
+           (unsigned) NUM_KEYS, (unsigned) (sizeof(BATCH) / sizeof(BATCH[0])));
+    menu_stats_dump([](const char* text) { fputs(text, stdout); });
+
+    const uint32_t num_displays = NUM_KEYS + 1;
+    const uint32_t num_callbacks = num_on_activate + num_on_current;
+    bool same = menu_stats.num_next == num_presses[MENU_EVENT_NEXT]
+        && menu_stats.num_prev == num_presses[MENU_EVENT_PREV]
+        && menu_stats.num_activate == num_presses[MENU_EVENT_ACTIVATE]
+        && menu_stats.num_back == num_presses[MENU_EVENT_BACK]
+        && menu_stats.num_reset == num_presses[MENU_EVENT_RESET]
+        && menu_stats.num_events == sizeof(BATCH) / sizeof(BATCH[0])
+        && menu_stats.num_display == num_displays
+        && menu_stats.num_on_activate == num_on_activate
+        && menu_stats.num_on_current == num_on_current
+        && menu_stats.render_time == num_displays * RENDER_TICKS
+        && menu_stats.render_time_max == RENDER_TICKS
+        && menu_stats.callback_time == num_callbacks * CALLBACK_TICKS
+        && menu_stats.callback_time_max == CALLBACK_TICKS;
+    for (uint8_t kind = 0; kind <= MENU_COMPONENT_MENU; ++kind) {
+        same &= menu_stats.num_renders[kind]
+            == renderer.get_num_renders(MenuComponentKind(kind));
+    }
+    printf("%-44s %12s\n", "  counters match renderer and callbacks",
+           same ? "yes" : "NO");
+    ok &= same;
+    menu_stats_set_clock(nullptr);
+#else
+    printf("\nMENUSYSTEM_STATS not defined\n");
+#endif
+
+    NullRenderer null_renderer(4);
+    MenuSystem bench_ms(null_renderer);
+    BenchTree tree(bench_ms, 16, 2);
+    bench_header("navigation cost");
+    bench_run("next(loop) + display", 1000000, [&](uint64_t) {
+        bench_ms.next(true);
+        bench_ms.display();
+    });
+    bench_run("activate + back", 1000000, [&](uint64_t) {
+        bench_ms.activate();
+        bench_ms.back();
+    });
+    return ok ? 0 : 1;
+}
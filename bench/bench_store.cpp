@@ -0,0 +1,227 @@
+/*
+ * bench_store.cpp - Persistence of numeric values.
+ *
+ * Saves the 60 numeric items of a settings tree through a file-backed
+ * MenuStorage and reports the bytes written per save when only some
+ * values changed, against rewriting the whole blob, and checks that a
+ * save writes nothing but the changed slots. Also checks that values
+ * survive a reload, that blobs of another version or with a corrupted
+ * header are refused and that a save cut short by a reset only loses the
+ * slot it was writing.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "bench.h"
+
+#include <MenuFileStorage.h>
+
+#include <stdio.h>
+#include <memory>
+#include <vector>
+
+static const char* PATH = "bench_store.bin";
+static const uint8_t NUM_MENUS = 6;
+static const uint8_t ITEMS_PER_MENU = 10;
+static const uint16_t VERSION = 1;
+static const uint16_t HEADER_SIZE = 8;
+static const uint16_t SLOT_SIZE = 6;
+
+// Half NumericMenuItem, half Int16MenuItem
+class Settings {
+public:
+    Settings() {
+        _menus.reserve(NUM_MENUS);
+        for (uint8_t m = 0; m < NUM_MENUS; ++m) {
+            _menus.emplace_back(new Menu("Menu"));
+            _ms.get_root_menu().add(_menus.back().get());
+            for (uint8_t i = 0; i < ITEMS_PER_MENU; i += 2) {
+                _floats.emplace_back(
+                    new NumericMenuItem("Float", 0.5f, 0, 100, 0.5f));
+                _menus.back()->add(_floats.back().get());
+                _ints.emplace_back(new Int16MenuItem("Int", 0, -500, 500));
+                _menus.back()->add(_ints.back().get());
+            }
+        }
+    }
+
+    Menu& get_root_menu() { return _ms.get_root_menu(); }
+
+    void set(uint16_t i, int16_t value) {
+        if (i % 2)
+            _ints[i / 2]->set_value(value);
+        else
+            _floats[i / 2]->set_value(value / 2.0f);
+    }
+
+    int16_t get(uint16_t i) const {
+        if (i % 2)
+            return _ints[i / 2]->get_value();
+        return int16_t(_floats[i / 2]->get_value() * 2);
+    }
+
+    bool same(Settings const& other) const {
+        bool same = true;
+        for (size_t i = 0; i < _floats.size(); ++i) {
+            same &= _floats[i]->get_value() == other._floats[i]->get_value();
+            same &= _ints[i]->get_value() == other._ints[i]->get_value();
+        }
+        return same;
+    }
+
+private:
+    MenuSystem _ms;
+    std::vector<std::unique_ptr<Menu>> _menus;
+    std::vector<std::unique_ptr<NumericMenuItem>> _floats;
+    std::vector<std::unique_ptr<Int16MenuItem>> _ints;
+};
+
+// Passes writes on until `budget` bytes were written, then drops the
+// rest, like a board reset in the middle of a save. Remembers the lowest
+// address written.
+class ResetStorage : public MenuStorage {
+public:
+    ResetStorage(MenuStorage& storage, uint32_t budget)
+    : _storage(storage), _budget(budget), _lowest_address(UINT16_MAX) {}
+
+    bool read(uint16_t address, void* data, uint16_t size) {
+        return _storage.read(address, data, size);
+    }
+
+    bool write(uint16_t address, void const* data, uint16_t size) {
+        if (address < _lowest_address)
+            _lowest_address = address;
+        const uint16_t length = size < _budget ? size : uint16_t(_budget);
+        _budget -= length;
+        return _storage.write(address, data, length);
+    }
+
+    uint16_t get_lowest_address() const { return _lowest_address; }
+
+private:
+    MenuStorage& _storage;
+    uint32_t _budget;
+    uint16_t _lowest_address;
+};
+
+static void check(bool& ok, const char* name, bool result) {
+    printf("%-44s %12s\n", name, result ? "yes" : "NO");
+    ok &= result;
+}
+
+int main() {
+    remove(PATH);
+    bool ok = true;
+
+    Settings settings;
+    MenuFileStorage storage(PATH);
+    MenuStore store(storage, VERSION);
+    store.add_all(settings.get_root_menu());
+
+    printf("\n%u slots, %u byte blob\n", store.get_num_slots(),
+           store.get_blob_size());
+    check(ok, "load from empty storage fails", !store.load());
+    check(ok, "first save writes every slot",
+          store.save() == store.get_num_slots());
+
+    printf("%-44s %12s %12s\n", "save", "slots", "bytes");
+    const uint16_t changes[] = {0, 1, 10, 60};
+    for (uint16_t num_changes : changes) {
+        for (uint16_t i = 0; i < num_changes; ++i)
+            settings.set(i * store.get_num_slots() / num_changes, 7);
+        const uint32_t bytes = storage.get_bytes_written();
+        const int16_t num_written = store.save();
+        char name[64];
+        snprintf(name, sizeof(name), "%u values changed", num_changes);
+        printf("%-44s %12d %12u\n", name, num_written,
+               (unsigned) (storage.get_bytes_written() - bytes));
+        for (uint16_t i = 0; i < num_changes; ++i)
+            settings.set(i * store.get_num_slots() / num_changes, i + 10);
+        store.save();
+    }
+    printf("%-44s %12s %12u\n", "whole blob", "",
+           (unsigned) store.get_blob_size());
+
+    settings.set(3, 42);
+    settings.set(20, 99);
+    store.save();
+    {
+        Settings loaded;
+        MenuFileStorage loaded_storage(PATH);
+        MenuStore loaded_store(loaded_storage, VERSION);
+        loaded_store.add_all(loaded.get_root_menu());
+        check(ok, "reload restores every value",
+              loaded_store.load() && loaded.same(settings)
+              && !loaded_store.is_dirty());
+
+        Settings fresh;
+        MenuStore other_version(loaded_storage, VERSION + 1);
+        other_version.add_all(fresh.get_root_menu());
+        Settings defaults;
+        check(ok, "other version refused, values untouched",
+              !other_version.load() && fresh.same(defaults));
+
+        uint8_t byte;
+        loaded_storage.read(3, &byte, 1);
+        byte ^= 0x10;
+        loaded_storage.write(3, &byte, 1);
+        Settings corrupted;
+        MenuStore corrupted_store(loaded_storage, VERSION);
+        corrupted_store.add_all(corrupted.get_root_menu());
+        check(ok, "corrupted header refused, values untouched",
+              !corrupted_store.load() && corrupted.same(defaults));
+        byte ^= 0x10;
+        loaded_storage.write(3, &byte, 1);
+    }
+
+    // Slots 3 and 20 change again; a reset hits in the middle of slot 20
+    {
+        MenuFileStorage file_storage(PATH);
+        ResetStorage reset_storage(file_storage, SLOT_SIZE + 3);
+        MenuStore torn_store(reset_storage, VERSION);
+        torn_store.add_all(settings.get_root_menu());
+        torn_store.load();
+        settings.set(3, 44);
+        settings.set(20, 101);
+        torn_store.save();
+        check(ok, "save leaves the header alone",
+              reset_storage.get_lowest_address() >= HEADER_SIZE);
+
+        Settings loaded;
+        Settings defaults;
+        MenuStore loaded_store(file_storage, VERSION);
+        loaded_store.add_all(loaded.get_root_menu());
+        bool torn = loaded_store.load() && loaded_store.is_dirty();
+        for (uint16_t i = 0; i < store.get_num_slots(); ++i) {
+            torn &= loaded.get(i)
+                == (i == 20 ? defaults.get(i) : settings.get(i));
+        }
+        check(ok, "reset mid-save loses only that slot", torn);
+        check(ok, "next save rewrites the blob",
+              loaded_store.save() == store.get_num_slots()
+              && !loaded_store.is_dirty() && loaded_store.load()
+              && !loaded_store.is_dirty());
+    }
+
+    // Restore a valid blob for the timings
+    store.load();
+    store.save();
+    bench_header("host cost (file backed)");
+    bench_run("is_dirty (no change)", 100000, [&](uint64_t) {
+        bench_keep(store.is_dirty());
+    });
+    bench_run("save (no change)", 100000, [&](uint64_t) {
+        store.save();
+    });
+    bench_run("save (1 change)", 20000, [&](uint64_t i) {
+        settings.set(5, i % 100);
+        store.save();
+    });
+    bench_run("load", 20000, [&](uint64_t) {
+        store.load();
+    });
+
+    remove(PATH);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+/*
+ * bench_table.cpp - MenuTableSystem benchmarks.
+ *
+ * Compares navigating an immutable MenuTable with navigating the equivalent
+ * object tree, and the RAM each of them needs.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "bench.h"
+
+#include <MenuTable.h>
+#include <stdio.h>
+#include <vector>
+
+static const uint64_t OPS = 1000000;
+
+class NullTableRenderer : public MenuTableRenderer {
+public:
+    void render(MenuTableSystem const& ms) const {
+        MenuNode const& menu = ms.get_node(ms.get_current_menu());
+        for (uint8_t i = 0; i < menu.count; ++i)
+            bench_keep(ms.get_node(menu.first + i));
+    }
+};
+
+// Same shape as BenchTree: the first child of every level but the last is
+// a menu leading to the next level.
+static std::vector<MenuNode> make_nodes(uint8_t width, uint8_t depth) {
+    std::vector<MenuNode> nodes;
+    nodes.push_back(menu_node("Root", 1, width));
+    for (uint8_t level = 0; level < depth; ++level) {
+        const bool has_submenu = level + 1 < depth;
+        const uint8_t next_level = nodes.size() + width;
+        for (uint8_t i = 0; i < width; ++i) {
+            if (i == 0 && has_submenu)
+                nodes.push_back(menu_node("Menu", next_level, width));
+            else
+                nodes.push_back(item_node("Item"));
+        }
+    }
+    return nodes;
+}
+
+static void bench_tree(uint8_t width, uint8_t depth) {
+    char title[64];
+    snprintf(title, sizeof(title), "width=%u depth=%u", width, depth);
+    bench_header(title);
+
+    std::vector<MenuNode> nodes = make_nodes(width, depth);
+    const MenuTable table = {nodes.data(), (uint8_t) nodes.size(), nullptr, 0};
+    NullTableRenderer table_renderer;
+    MenuTableSystem tms(table, table_renderer, nullptr);
+    tms.reset();
+
+    NullRenderer renderer;
+    MenuSystem ms(renderer);
+    BenchTree tree(ms, width, depth);
+
+    bench_run("object next(loop)", OPS, [&](uint64_t) { ms.next(true); });
+    bench_run("table next(loop)", OPS, [&](uint64_t) { tms.next(true); });
+    ms.reset();
+    tms.reset();
+
+    if (depth > 1) {
+        bench_run("object activate+back (to depth)", OPS / depth, [&](uint64_t) {
+            for (uint8_t i = 1; i < depth; ++i)
+                ms.activate();
+            for (uint8_t i = 1; i < depth; ++i)
+                ms.back();
+        });
+        bench_run("table activate+back (to depth)", OPS / depth, [&](uint64_t) {
+            for (uint8_t i = 1; i < depth; ++i)
+                tms.activate();
+            for (uint8_t i = 1; i < depth; ++i)
+                tms.back();
+        });
+    }
+
+    const size_t num_menus = depth - 1;
+    const size_t num_items = (size_t) width * depth - num_menus;
+    const size_t object_ram = sizeof(MenuSystem) + sizeof(Menu) * (num_menus + 1)
+        + sizeof(MenuItem) * num_items
+        + sizeof(MenuComponent*) * width * depth;
+    printf("%-44s %12zu bytes\n", "object tree RAM", object_ram);
+    printf("%-44s %12zu bytes\n", "table RAM (nodes in flash)",
+           sizeof(MenuTableSystem));
+    printf("%-44s %12zu bytes\n", "table flash", sizeof(MenuNode) * nodes.size());
+}
+
+int main() {
+    bench_tree(16, 1);
+    bench_tree(16, 4);
+    bench_tree(64, 3);
+    return 0;
+}
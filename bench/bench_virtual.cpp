@@ -0,0 +1,154 @@
+/*
+ * bench_virtual.cpp - Generated menu benchmarks.
+ *
+ * Navigates and renders a VirtualMenu of growing length through a 4 line
+ * window and compares it with a Menu holding one object per entry. The
+ * cost per step must not depend on the number of entries, constructing it
+ * must not touch the heap, a pool of one slot must leave it empty and
+ * components can't be added to it. Also built as bench_virtual_wide with
+ * MENUSYSTEM_INDEX_TYPE=uint16_t.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const uint64_t OPS = 1000000;
+static const uint8_t VISIBLE = 4;
+static const uint8_t POOL_SIZE = VISIBLE + 1;
+
+// A pooled entry keeps its own name buffer.
+class EntryItem : public MenuItem {
+public:
+    EntryItem() : MenuItem(_text) { _text[0] = '\0'; }
+    char _text[12];
+};
+
+static menu_index_t num_entries = 0;
+static uint64_t num_generated = 0;
+static menu_index_t last_activated = 0;
+
+static menu_index_t count_entries(VirtualMenu const&) {
+    return num_entries;
+}
+
+static void generate_entry(VirtualMenu const&, menu_index_t num,
+                           MenuComponent& component) {
+    ++num_generated;
+    EntryItem& entry = static_cast<EntryItem&>(component);
+    snprintf(entry._text, sizeof(entry._text), "Entry %u", num);
+}
+
+static void on_entry(MenuComponent* p_component) {
+    last_activated = p_component->get_parent()->get_component_num(p_component);
+}
+
+static bool check(VirtualMenu& menu, MenuSystem& ms) {
+    bool ok = true;
+    ms.reset();
+    ms.activate();
+    for (menu_index_t num = 0; num < num_entries; ++num) {
+        MenuComponent const* p_current =
+            ms.get_current_menu()->get_current_component();
+        char expected[12];
+        snprintf(expected, sizeof(expected), "Entry %u", num);
+        ok &= strcmp(p_current->get_name(), expected) == 0;
+        ok &= p_current->is_current();
+        ms.display();
+        ms.next();
+    }
+    ms.activate();
+    ok &= last_activated == num_entries - 1;
+    ok &= ms.jump_to(ms.get_current_menu()->get_current_component());
+    ok &= ms.get_current_menu() == &menu;
+    ok &= ms.back() && ms.get_current_menu() == &ms.get_root_menu();
+
+    // Entries only come from the generator
+    MenuItem extra("Extra");
+    ok &= !menu.add(&extra) && !menu.insert(0, &extra)
+        && extra.get_parent() == nullptr;
+    return ok;
+}
+
+static bool bench_virtual(menu_index_t length) {
+    num_entries = length;
+    EntryItem items[POOL_SIZE];
+    MenuComponent* pool[POOL_SIZE];
+    menu_index_t slot_nums[POOL_SIZE];
+    for (uint8_t i = 0; i < POOL_SIZE; ++i) {
+        items[i].set_on_activate_cb(on_entry);
+        pool[i] = &items[i];
+    }
+
+    NullRenderer renderer(VISIBLE);
+    MenuSystem ms(renderer);
+    const uint64_t allocs = bench_alloc_count();
+    VirtualMenu menu("Entries", count_entries, generate_entry,
+                     pool, slot_nums, POOL_SIZE);
+    bool ok = bench_alloc_count() == allocs;
+    ms.get_root_menu().add(&menu);
+
+    // One slot would be shared by the current and the rendered entry
+    VirtualMenu too_small("Too small", count_entries, generate_entry,
+                          pool, slot_nums, 1);
+    ok &= too_small.get_num_components() == 0;
+    ms.get_root_menu().add(&too_small);
+    ms.reset();
+    ok &= check(menu, ms);
+
+    char title[64];
+    snprintf(title, sizeof(title), "VirtualMenu, %u entries, pool of %u",
+             length, POOL_SIZE);
+    bench_header(title);
+
+    ms.reset();
+    ms.activate();
+    ms.display();
+    const uint64_t generated = num_generated;
+    bench_run("next(loop) + display", OPS, [&](uint64_t) {
+        ms.next(true);
+        ms.display();
+    });
+    printf("%-44s %12.3f\n", "  generator calls/op",
+           double(num_generated - generated) / (OPS + OPS / 10));
+    printf("%-44s %12zu\n", "  entry bytes",
+           sizeof(items) + sizeof(pool) + sizeof(slot_nums));
+    printf("%-44s %12s\n", "  navigation and callbacks correct",
+           ok ? "yes" : "NO");
+    return ok;
+}
+
+static void bench_plain(menu_index_t length) {
+    NullRenderer renderer(VISIBLE);
+    MenuSystem ms(renderer);
+    BenchTree tree(ms, length, 1);
+
+    char title[64];
+    snprintf(title, sizeof(title), "Menu, %u MenuItems", length);
+    bench_header(title);
+    bench_run("next(loop) + display", OPS, [&](uint64_t) {
+        ms.next(true);
+        ms.display();
+    });
+    printf("%-44s %12zu\n", "  entry bytes",
+           length * (sizeof(MenuItem) + sizeof(MenuComponent*)));
+}
+
+int main() {
+    const menu_index_t lengths[] = {16, 64, 254};
+
+    bool ok = true;
+    for (menu_index_t length : lengths) {
+        ok &= bench_virtual(length);
+        bench_plain(length);
+    }
+    if (MENU_INDEX_MAX >= 5000) {
+        ok &= bench_virtual(menu_index_t(5000));
+        bench_plain(menu_index_t(5000));
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+/*
+ * ram_report.cpp - RAM footprint of the menu objects.
+ *
+ * Built once with the default layout and once with MENUSYSTEM_COMPACT.
+ * Prints the size of each class and the RAM taken by a 60 component tree:
+ * 6 submenus of 9 items each, every item sharing one callback. The sizes
+ * are those of the host; on AVR pointers take 2 bytes instead of 8. The
+ * compact build also checks that overflowing its tables is reported and
+ * that a menu that didn't fit refuses children instead of losing them.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include <MenuSystem.h>
+
+#include <stdio.h>
+#include <memory>
+#include <vector>
+
+static const uint8_t NUM_MENUS = 6;
+static const uint8_t ITEMS_PER_MENU = 9;
+
+static uint8_t num_activations = 0;
+
+static void on_activate(MenuComponent*) {
+    ++num_activations;
+}
+
+#ifdef MENUSYSTEM_COMPACT
+// Sets N distinct callbacks on a component, one after the other
+template <int N>
+struct DistinctCallbacks {
+    static void callback(MenuComponent*) {}
+
+    static void set(MenuComponent& component) {
+        component.set_on_current_cb(callback);
+        DistinctCallbacks<N - 1>::set(component);
+    }
+};
+
+template <>
+struct DistinctCallbacks<0> {
+    static void set(MenuComponent&) {}
+};
+#endif
+
+class NoRenderer : public MenuComponentRenderer {
+public:
+    void render(Menu const&) const {}
+    void render(MenuItem const&) const {}
+    void render(BackMenuItem const&) const {}
+    void render(NumericMenuItem const&) const {}
+};
+
+static void report(const char* name, size_t size) {
+    printf("%-40s %8zu\n", name, size);
+}
+
+int main() {
+#ifdef MENUSYSTEM_COMPACT
+    printf("\nRAM footprint, compact layout (MENUSYSTEM_COMPACT)\n");
+#else
+    printf("\nRAM footprint, default layout\n");
+#endif
+    printf("%-40s %8s\n", "", "bytes");
+    report("sizeof(void*)", sizeof(void*));
+    report("sizeof(MenuComponent)", sizeof(MenuComponent));
+    report("sizeof(MenuItem)", sizeof(MenuItem));
+    report("sizeof(BackMenuItem)", sizeof(BackMenuItem));
+    report("sizeof(NumericMenuItem)", sizeof(NumericMenuItem));
+    report("sizeof(Menu)", sizeof(Menu));
+    report("sizeof(MenuSystem)", sizeof(MenuSystem));
+
+    NoRenderer renderer;
+    MenuSystem ms(renderer);
+    std::unique_ptr<Menu> menus[NUM_MENUS];
+    std::unique_ptr<MenuItem> items[NUM_MENUS * ITEMS_PER_MENU];
+
+    ms.get_root_menu().reserve(NUM_MENUS);
+    for (uint8_t m = 0; m < NUM_MENUS; ++m) {
+        menus[m].reset(new Menu("Menu"));
+        menus[m]->reserve(ITEMS_PER_MENU);
+        ms.get_root_menu().add(menus[m].get());
+        for (uint8_t i = 0; i < ITEMS_PER_MENU; ++i) {
+            items[m * ITEMS_PER_MENU + i].reset(
+                new MenuItem("Item", on_activate));
+            menus[m]->add(items[m * ITEMS_PER_MENU + i].get());
+        }
+    }
+    ms.reset();
+
+    const uint8_t num_components = NUM_MENUS * (1 + ITEMS_PER_MENU);
+    const size_t objects = sizeof(MenuSystem) + sizeof(Menu)
+        + NUM_MENUS * sizeof(Menu)
+        + NUM_MENUS * ITEMS_PER_MENU * sizeof(MenuItem);
+    const size_t child_lists = num_components * sizeof(MenuComponent*);
+#ifdef MENUSYSTEM_COMPACT
+    const size_t tables = MENUSYSTEM_MAX_MENUS * sizeof(Menu*)
+        + MENUSYSTEM_MAX_CALLBACKS * sizeof(MenuComponent::ComponentCbPtr);
+#else
+    const size_t tables = 0;
+#endif
+
+    char title[64];
+    snprintf(title, sizeof(title), "%u component tree", num_components);
+    printf("\n%-40s %8s\n", title, "bytes");
+    report("objects (system, root, menus, items)", objects);
+    report("child lists", child_lists);
+    report("shared menu and callback tables", tables);
+    report("total", objects + child_lists + tables);
+
+    // The layout must not change behaviour: walk into every submenu,
+    // activate its last item and come back.
+    bool ok = true;
+    for (uint8_t m = 0; m < NUM_MENUS; ++m) {
+        ms.activate();
+        for (uint8_t i = 1; i < ITEMS_PER_MENU; ++i)
+            ms.next();
+        ms.activate();
+        ok &= ms.get_current_menu() == menus[m].get();
+        ok &= ms.get_current_menu()->get_current_component()
+            == items[m * ITEMS_PER_MENU + ITEMS_PER_MENU - 1].get();
+        ok &= items[m * ITEMS_PER_MENU]->get_parent() == menus[m].get();
+        ok &= ms.back();
+        ok &= ms.get_current_menu() == &ms.get_root_menu();
+        ms.next();
+    }
+    ok &= num_activations == NUM_MENUS;
+    printf("%-40s %8s\n", "navigation unchanged", ok ? "yes" : "NO");
+
+#ifdef MENUSYSTEM_COMPACT
+    // Overflowing the tables is reported, and the menus that didn't fit
+    // refuse children, so the tree above keeps working
+    bool overflow_ok = !menu_compact_has_overflowed();
+    MenuItem extra_item("Item");
+    DistinctCallbacks<MENUSYSTEM_MAX_CALLBACKS>::set(extra_item);
+    overflow_ok &= menu_compact_has_overflowed();
+
+    std::vector<std::unique_ptr<Menu>> extra_menus;
+    for (uint16_t m = 0; m < MENUSYSTEM_MAX_MENUS; ++m)
+        extra_menus.emplace_back(new Menu("Extra"));
+    Menu& unregistered = *extra_menus.back();
+    overflow_ok &= !unregistered.add(&extra_item)
+        && !unregistered.insert(0, &extra_item)
+        && unregistered.get_num_components() == 0;
+    ms.get_root_menu().add(&unregistered);
+    ms.reset();
+    while (ms.get_current_menu()->get_current_component() != &unregistered)
+        ms.next();
+    ms.activate();
+    overflow_ok &= ms.get_current_menu() == &unregistered && ms.back()
+        && ms.get_current_menu() == &ms.get_root_menu();
+    ms.get_root_menu().remove(&unregistered);
+
+    // Freed slots are reused
+    extra_menus.clear();
+    Menu reused("Reused");
+    overflow_ok &= reused.add(&extra_item)
+        && extra_item.get_parent() == &reused;
+    printf("%-40s %8s\n", "table overflow reported",
+           overflow_ok ? "yes" : "NO");
+    ok &= overflow_ok;
+#endif
+
+    return ok ? 0 : 1;
+}
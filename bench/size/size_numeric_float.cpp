@@ -0,0 +1,41 @@
+/*
+ * size_numeric_float.cpp - Code size probe for the float NumericMenuItem.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include <MenuSystem.h>
+
+class SizeRenderer : public MenuComponentRenderer {
+public:
+    void render(Menu const& menu) const {
+        menu.get_current_component()->render(*this);
+    }
+    void render(MenuItem const&) const {}
+    void render(BackMenuItem const&) const {}
+    void render(NumericMenuItem const& menu_item) const {
+        char buffer[16];
+        menu_item.format_value(buffer, sizeof(buffer));
+        sink = buffer[0];
+    }
+
+    static volatile char sink;
+};
+volatile char SizeRenderer::sink;
+
+SizeRenderer renderer;
+MenuSystem ms(renderer);
+NumericMenuItem item("Value", 0, -100, 100, 0.5);
+
+int main() {
+    ms.get_root_menu().add(&item);
+    ms.reset();
+    ms.activate();
+    for (volatile int i = 0; i < 10; ++i) {
+        ms.next();
+        ms.prev(true);
+        ms.display();
+    }
+    return 0;
+}
@@ -0,0 +1,42 @@
+/*
+ * size_render_static.cpp - Code size probe for a statically dispatched
+ * renderer.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include <MenuSystem.h>
+
+volatile const void* sink;
+
+class SizeRenderer {
+public:
+    uint8_t get_visible_count() const { return 0; }
+    void render(Menu const& menu, MenuChangeSet const&) const {
+        for (menu_index_t i = 0; i < menu.get_num_visible(); ++i)
+            menu_static_render(*this, *menu.get_visible_component(i));
+    }
+    void render(Menu const& menu) const { sink = &menu; }
+    void render(MenuItem const& menu_item) const { sink = &menu_item; }
+    void render(BackMenuItem const& menu_item) const { sink = &menu_item; }
+    void render(NumericMenuItem const& menu_item) const { sink = &menu_item; }
+};
+
+SizeRenderer renderer;
+MenuSystem ms;
+MenuItem item("Item");
+BackMenuItem back("Back", &ms);
+NumericMenuItem numeric("Value", 0, -100, 100, 1);
+
+int main() {
+    ms.get_root_menu().add(&item);
+    ms.get_root_menu().add(&back);
+    ms.get_root_menu().add(&numeric);
+    ms.reset();
+    for (volatile int i = 0; i < 10; ++i) {
+        ms.next(true);
+        ms.display(renderer);
+    }
+    return 0;
+}
@@ -0,0 +1,39 @@
+/*
+ * size_render_virtual.cpp - Code size probe for a MenuComponentRenderer.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include <MenuSystem.h>
+
+volatile const void* sink;
+
+class SizeRenderer : public MenuComponentRenderer {
+public:
+    void render(Menu const& menu) const {
+        for (menu_index_t i = 0; i < menu.get_num_visible(); ++i)
+            menu.get_visible_component(i)->render(*this);
+    }
+    void render(MenuItem const& menu_item) const { sink = &menu_item; }
+    void render(BackMenuItem const& menu_item) const { sink = &menu_item; }
+    void render(NumericMenuItem const& menu_item) const { sink = &menu_item; }
+};
+
+SizeRenderer renderer;
+MenuSystem ms(renderer);
+MenuItem item("Item");
+BackMenuItem back("Back", &ms);
+NumericMenuItem numeric("Value", 0, -100, 100, 1);
+
+int main() {
+    ms.get_root_menu().add(&item);
+    ms.get_root_menu().add(&back);
+    ms.get_root_menu().add(&numeric);
+    ms.reset();
+    for (volatile int i = 0; i < 10; ++i) {
+        ms.next(true);
+        ms.display();
+    }
+    return 0;
+}
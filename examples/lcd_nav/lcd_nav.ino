@@ -2,13 +2,20 @@
  * lcd_nav.ino - Example code using the menu system library
  *
  * This example shows using the menu system with a 16x2 LCD display
- * (controled over serial).
+ * (controled over serial or with a rotary encoder).
+ *
+ * The encoder interrupt only queues events; loop() drains the queue into
+ * the menu system, so encoder steps arriving while the LCD is being
+ * written or a callback runs are not lost. The queue takes a single
+ * producer, so serial input, read in loop() itself, is processed directly.
  *
  * Copyright (c) 2015 arduino-menusystem
  * Licensed under the MIT license (see LICENSE)
  */
 
 #include <MenuSystem.h>
+#include <MenuEventQueue.h>
+#include <TextGridRenderer.h>
 #include <LiquidCrystal.h>
 
 // renderer
@@ -23,30 +30,19 @@
 //    * LCD R/W pin to ground
 LiquidCrystal lcd = LiquidCrystal(8, 9, 4, 5, 6, 7);
 
-class MyRenderer : public MenuComponentRenderer {
+// Keeps a copy of the screen and only sends the characters that changed,
+// so the display isn't cleared and rewritten on every key press.
+class MyRenderer : public TextGridRenderer {
 public:
-    void render(Menu const& menu) const {
-        lcd.clear();
-        lcd.setCursor(0,0);
-        lcd.print(menu.get_name());
-        lcd.setCursor(0,1);
-        menu.get_current_component()->render(*this);
-    }
-
-    void render_menu_item(MenuItem const& menu_item) const {
-        lcd.print(menu_item.get_name());
-    }
+    MyRenderer() : TextGridRenderer(16, 2) {}
 
-    void render_back_menu_item(BackMenuItem const& menu_item) const {
-        lcd.print(menu_item.get_name());
+protected:
+    void set_cursor(uint8_t column, uint8_t row) const {
+        lcd.setCursor(column, row);
     }
 
-    void render_numeric_menu_item(NumericMenuItem const& menu_item) const {
-        lcd.print(menu_item.get_name());
-    }
-
-    void render_menu(Menu const& menu) const {
-        lcd.print(menu.get_name());
+    void print(const char* text, uint8_t length) const {
+        lcd.write((const uint8_t*) text, length);
     }
 };
 MyRenderer my_renderer;
@@ -71,18 +67,24 @@ void on_item1_selected(MenuComponent* p_menu_component) {
     lcd.setCursor(0,1);
     lcd.print("Item1 Selected  ");
     delay(1500); // so we can look the result on the LCD
+    // The callback wrote to the LCD behind the renderer's back
+    my_renderer.invalidate();
 }
 
 void on_item2_selected(MenuComponent* p_menu_component) {
     lcd.setCursor(0,1);
     lcd.print("Item2 Selected  ");
     delay(1500); // so we can look the result on the LCD
+    // The callback wrote to the LCD behind the renderer's back
+    my_renderer.invalidate();
 }
 
 void on_item3_selected(MenuComponent* p_menu_component) {
     lcd.setCursor(0,1);
     lcd.print("Item3 Selected  ");
     delay(1500); // so we can look the result on the LCD
+    // The callback wrote to the LCD behind the renderer's back
+    my_renderer.invalidate();
 }
 
 void serial_print_help() {
@@ -96,33 +98,48 @@ void serial_print_help() {
     Serial.println("***************");
 }
 
+// Input
+
+// Rotary encoder A and B on the interrupt pins 2 and 3
+const int encoder_a_pin = 2;
+const int encoder_b_pin = 3;
+
+MenuEvent event_buffer[16];
+MenuEventQueue events(event_buffer, 16);
+
+void on_encoder_edge() {
+    // B leads A when turning clockwise
+    if (digitalRead(encoder_a_pin) == digitalRead(encoder_b_pin))
+        events.push(MENU_EVENT_PREV);
+    else
+        events.push(MENU_EVENT_NEXT);
+}
+
 void serial_handler() {
     char inChar;
     if ((inChar = Serial.read()) > 0) {
+        MenuEvent event;
         switch (inChar) {
             case 'w': // Previus item
-                ms.prev();
-                ms.display();
+                event = MENU_EVENT_PREV;
                 break;
             case 's': // Next item
-                ms.next();
-                ms.display();
+                event = MENU_EVENT_NEXT;
                 break;
             case 'a': // Back presed
-                ms.back();
-                ms.display();
+                event = MENU_EVENT_BACK;
                 break;
             case 'd': // Select presed
-                ms.select();
-                ms.display();
+                event = MENU_EVENT_ACTIVATE;
                 break;
             case '?':
             case 'h': // Display help
                 serial_print_help();
-                break;
+                return;
             default:
-                break;
+                return;
         }
+        ms.process(&event, 1);
     }
 }
 
@@ -134,14 +151,21 @@ void setup() {
 
     serial_print_help();
 
-    ms.get_root_menu().add_item(&mm_mi1);
-    ms.get_root_menu().add_item(&mm_mi2);
-    ms.get_root_menu().add_menu(&mu1);
-    mu1.add_item(&mu1_mi1);
+    pinMode(encoder_a_pin, INPUT_PULLUP);
+    pinMode(encoder_b_pin, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(encoder_a_pin), on_encoder_edge,
+                    CHANGE);
+
+    ms.get_root_menu().add(&mm_mi1);
+    ms.get_root_menu().add(&mm_mi2);
+    ms.get_root_menu().add(&mu1);
+    mu1.add(&mu1_mi1);
 
     ms.display();
 }
 
 void loop() {
     serial_handler();
+    // Displays once for all the events queued since the last loop
+    events.drain(ms);
 }
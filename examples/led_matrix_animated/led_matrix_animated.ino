@@ -10,6 +10,7 @@
 
 #include <ht1632c.h>
 #include <MenuSystem.h>
+#include <MenuAnimator.h>
 
 // Display constants
 
@@ -23,205 +24,131 @@
 ht1632c ledMatrix = ht1632c(&PORTB, PIN_LED_DATA, PIN_LED_WR, PIN_LED_CLOCK,
                             PIN_LED_CS, GEOM_32x16, 2);
 
-class MyRenderer : public MenuComponentRenderer {
+// Transitions between two names, drawn one frame at a time by the
+// animator so the main loop keeps running while they play.
+
+MenuAnimator animator(30); // a frame at most every 30 ms
+
+class NameTransition : public MenuTransition {
 public:
-    MyRenderer()
+    NameTransition()
     : _led_height(16),
       _led_width(32),
       _font_width(5),
       _font_height(7),
-      _color(RED) {
+      _color(RED),
+      _from(""),
+      _to("") {
     }
 
-    void render(Menu const& menu) const {
-        ledMatrix.clear();
+    void set_names(char const* from, char const* to) {
+        _from = from;
+        _to = to;
+    }
 
-        const uint8_t prev_comp_num = menu.get_previous_component_num();
-        _p_prev_comp = menu.get_menu_component(prev_comp_num);
-        auto cp_m_comp = menu.get_current_component();
-        cp_m_comp->render(*this);
+protected:
+    void _draw_name(char const* name, int x, int y) const {
+        for (size_t i = 0; i < strlen(name); i++)
+            ledMatrix.putchar((i * _font_width) + x, y, name[i], _color);
     }
 
-    void render_menu_item(MenuItem const& menu_item) const {
-        auto prev_name = _p_prev_comp->get_name();
-        auto curr_name = menu_item.get_name();
-        _fade(prev_name, curr_name);
+    int _centre_x(char const* name) const {
+        return (_led_width - _font_width * (int) strlen(name)) / 2;
     }
 
-    void render_back_menu_item(BackMenuItem const& menu_item) const {
-        auto prev_name = _p_prev_comp->get_name();
-        auto curr_name = menu_item.get_name();
-        _fade(prev_name, curr_name);
+    int _centre_y() const {
+        return (_led_height / 2) - (_font_height / 2);
     }
 
-    void render_numeric_menu_item(NumericMenuItem const& menu_item) const {
-        auto prev_name = _p_prev_comp->get_name();
-        auto curr_name = menu_item.get_name();
-        _fade(prev_name, curr_name);
+protected:
+    const uint8_t _led_height;
+    const uint8_t _led_width;
+    const uint8_t _font_width;
+    const uint8_t _font_height;
+    const uint8_t _color;
+    char const* _from;
+    char const* _to;
+};
+
+// Dims the old name, then brightens the new one
+class Fade : public NameTransition {
+public:
+    void draw_frame(uint8_t progress) const {
+        const bool fading_in = progress > MENU_TRANSITION_END / 2;
+        char const* name = fading_in ? _to : _from;
+        const int brightness = fading_in
+            ? (progress - MENU_TRANSITION_END / 2) * 10 / (MENU_TRANSITION_END / 2)
+            : 10 - progress * 10 / (MENU_TRANSITION_END / 2);
+
+        ledMatrix.clear();
+        _draw_name(name, _centre_x(name), _centre_y());
+        ledMatrix.sendframe();
+        ledMatrix.pwm(brightness);
     }
+};
+
+// Pushes the old name out while the new one slides in
+class Slide : public NameTransition {
+public:
+    enum Direction { UP, DOWN, LEFT, RIGHT };
 
-    void render_menu(Menu const& menu) const {
-        auto prev_name = _p_prev_comp->get_name();
-        auto curr_name = menu.get_name();
-        _fade(prev_name, curr_name);
+    void set_direction(Direction direction) {
+        _direction = direction;
     }
 
-private:
-    enum VSlideDirection { VSLIDE_UP, VSLIDE_DOWN };
-
-    void _vslide(char const* menu1, char const* menu2, VSlideDirection d) const {
-        // Calculate vertical position
-        int menu1_start_y = (_led_height / 2) - (_font_height / 2);
-        int menu2_target_y = menu1_start_y;
-        int menu2_start_y;
-        if (d == VSLIDE_UP) {
-            menu2_start_y = menu1_start_y + _led_height;
+    void draw_frame(uint8_t progress) const {
+        const bool vertical = _direction == UP || _direction == DOWN;
+        const int size = vertical ? _led_height : _led_width;
+        const bool backwards = _direction == UP || _direction == LEFT;
+        int offset = size * progress / MENU_TRANSITION_END;
+        if (backwards)
+            offset = -offset;
+        const int to_offset = backwards ? offset + size : offset - size;
+
+        ledMatrix.clear();
+        if (vertical) {
+            _draw_name(_from, _centre_x(_from), _centre_y() + offset);
+            _draw_name(_to, _centre_x(_to), _centre_y() + to_offset);
         } else {
-            menu2_start_y = menu1_start_y - _led_height;
-        }
-        int menu1_y = menu1_start_y;
-        int menu2_y = menu2_start_y;
-
-        // Calculate horizontal position
-        int menu1_text_width = _font_width * strlen(menu1);
-        int menu1_pixel_spare = _led_width - menu1_text_width;
-        int menu1_x_idnt = (int) floor(menu1_pixel_spare / 2);
-
-        int menu2_text_width = _font_width * strlen(menu2);
-        int menu2_pixel_spare = _led_width - menu2_text_width;
-        int menu2_x_idnt = (int) floor(menu2_pixel_spare / 2);
-
-        while (1) {
-            ledMatrix.clear();
-            for (size_t i = 0; i < strlen(menu1); i++) {
-                ledMatrix.putchar(
-                    (i * _font_width) + menu1_x_idnt,
-                    menu1_y, menu1[i], _color
-                );
-            }
-            for (size_t i = 0; i < strlen(menu2); i++) {
-                ledMatrix.putchar(
-                    (i * _font_width) + menu2_x_idnt,
-                    menu2_y, menu2[i], _color
-                );
-            }
-            ledMatrix.sendframe();
-
-            if (menu2_y == menu2_target_y) {
-                break;
-            }
-
-            if (d == VSLIDE_UP) {
-                menu1_y -= 1;
-                menu2_y -= 1;
-            } else {
-                menu1_y += 1;
-                menu2_y += 1;
-            }
-
-            delay(5);
+            _draw_name(_from, _centre_x(_from) + offset, _centre_y());
+            _draw_name(_to, _centre_x(_to) + to_offset, _centre_y());
         }
+        ledMatrix.sendframe();
     }
 
-    enum HSlideDirection { HSLIDE_LEFT, HSLIDE_RIGHT };
-
-    void _hslide(char const* menu1, char const* menu2, HSlideDirection d) const {
-        // Calculate vertical position
-        int y_idnt = (_led_height / 2) - (_font_height / 2);
-
-        // Calculate horizontal position
-        int menu1_text_width = _font_width * strlen(menu1);
-        int menu1_pixel_spare = _led_width - menu1_text_width;
-        int menu1_start_x = (int) floor(menu1_pixel_spare / 2);
-        int menu2_text_width = _font_width * strlen(menu2);
-        int menu2_pixel_spare = _led_width - menu2_text_width;
-        int menu2_target_x = (int) floor(menu2_pixel_spare / 2);
-        int menu2_start_x;
-        if (d == HSLIDE_LEFT) {
-            menu2_start_x = menu1_start_x + _led_width;
-        } else {
-            menu2_start_x = menu1_start_x - _led_width;
-        }
-        int menu1_x = menu1_start_x;
-        int menu2_x = menu2_start_x;
-
-        while (1) {
-            ledMatrix.clear();
-            for (size_t i = 0; i < strlen(menu1); i++) {
-                ledMatrix.putchar(
-                    (i * _font_width) + menu1_x,
-                    y_idnt, menu1[i], _color
-                );
-            }
-            for (size_t i = 0; i < strlen(menu2); i++) {
-                ledMatrix.putchar(
-                    (i * _font_width) + menu2_x,
-                    y_idnt, menu2[i], _color
-                );
-            }
-            ledMatrix.sendframe();
-
-            if (menu2_x == menu2_target_x) {
-                break;
-            }
-
-            if (d == HSLIDE_LEFT) {
-                menu1_x -= 1;
-                menu2_x -= 1;
-            } else {
-                menu1_x += 1;
-                menu2_x += 1;
-            }
-
-            delay(5);
-        }
+private:
+    Direction _direction = UP;
+};
+
+// Fades between names; use a Slide instead of the Fade to scroll them.
+class MyRenderer : public MenuComponentRenderer {
+public:
+    void render(Menu const& menu) const {
+        const menu_index_t prev_comp_num = menu.get_previous_component_num();
+        _p_prev_comp = menu.get_menu_component(prev_comp_num);
+        menu.get_current_component()->render(*this);
     }
 
-    void _fade(char const* menu1, char const* menu2) const {
-        int y_idnt = (_led_height / 2) - (_font_height / 2);
-
-        int menu1_text_width = _font_width * strlen(menu1);
-        int menu1_pixel_spare = _led_width - menu1_text_width;
-        int menu1_x_idnt = (int) floor(menu1_pixel_spare / 2);
-        for (size_t i = 0; i < strlen(menu1); i++) {
-            ledMatrix.putchar(
-                (i * _font_width) + menu1_x_idnt,
-                y_idnt, menu1[i], _color
-            );
-        }
-        ledMatrix.sendframe();
+    void render(MenuItem const& menu_item) const {
+        _start(menu_item.get_name());
+    }
 
-        int brightness = 10;
-        while (brightness > 0) {
-            ledMatrix.pwm(--brightness);
-            delay(30);
-        }
-        ledMatrix.clear();
+    void render(BackMenuItem const& menu_item) const {
+        _start(menu_item.get_name());
+    }
 
-        int menu2_text_width = _font_width * strlen(menu2);
-        int menu2_pixel_spare = _led_width - menu2_text_width;
-        int menu2_x_idnt = (int) floor(menu2_pixel_spare / 2);
-        for (size_t i = 0; i < strlen(menu2); i++) {
-            ledMatrix.putchar(
-                (i * _font_width) + menu2_x_idnt,
-                y_idnt, menu2[i], _color
-            );
-        }
-        ledMatrix.sendframe();
-        delay(30);
-        while (brightness < 10) {
-            ledMatrix.pwm(++brightness);
-            delay(30);
-        }
+    void render(NumericMenuItem const& menu_item) const {
+        _start(menu_item.get_name());
     }
 
 private:
-    const uint8_t _led_height;
-    const uint8_t _led_width;
-    const uint8_t _font_width;
-    const uint8_t _font_height;
-    const uint8_t _color;
+    void _start(char const* name) const {
+        _fade.set_names(_p_prev_comp->get_name(), name);
+        animator.start(_fade, millis(), 600);
+    }
 
+private:
+    mutable Fade _fade;
     mutable MenuComponent const* _p_prev_comp;
 };
 MyRenderer my_renderer;
@@ -242,13 +169,22 @@ void setup() {
     ledMatrix.pwm(10);
     ledMatrix.setfont(FONT_5x7);
 
-    ms.get_root_menu().add_item(&mi_one);
-    ms.get_root_menu().add_item(&mi_two);
-    ms.get_root_menu().add_item(&mi_three);
+    ms.get_root_menu().add(&mi_one);
+    ms.get_root_menu().add(&mi_two);
+    ms.get_root_menu().add(&mi_three);
 }
 
 void loop() {
-    ms.next(true);
-    ms.display();
-    delay(1000);
+    static uint32_t next_step = 0;
+    const uint32_t now = millis();
+
+    // Anything sent over serial skips the transition and moves on at once.
+    // Comparing the difference keeps working when millis() wraps.
+    if (Serial.read() >= 0 || (int32_t) (now - next_step) >= 0) {
+        animator.finish();
+        ms.next(true);
+        ms.display();
+        next_step = now + 1000;
+    }
+    animator.tick(now);
 }
@@ -3,9 +3,9 @@
 CustomNumericMenuItem::CustomNumericMenuItem(
         uint8_t width, const char* name, float value, float minValue,
         float maxValue, float increment, FormatValueFnPtr on_format_value)
-: NumericMenuItem(name, nullptr, value, minValue, maxValue, increment,
-                  on_format_value),
+: NumericMenuItem(name, value, minValue, maxValue, increment),
   _width(width) {
+    set_value_formatter(on_format_value);
 }
 
 uint8_t CustomNumericMenuItem::get_width() const {
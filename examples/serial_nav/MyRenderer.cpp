@@ -3,48 +3,15 @@
 // Serial terminal
 extern Serial pc;
 
-void MyRenderer::render(Menu const& menu) const {
-    pc.printf("%s", "\nCurrent menu name: ");
-    pc.printf("%s\n", menu.get_name());
-    string buffer;
-    for (int i = 0; i < menu.get_num_components(); ++i) {
-        MenuComponent const* cp_m_comp = menu.get_menu_component(i);
-        cp_m_comp->render(*this);
-
-        if (cp_m_comp->is_current())
-            pc.printf("%s", "<<< ");
-        pc.printf("%s\n", "");
-    }
-}
-
-void MyRenderer::render_menu_item(MenuItem const& menu_item) const {
-    pc.printf("%s", menu_item.get_name());
-}
-
-void MyRenderer::render_back_menu_item(BackMenuItem const& menu_item) const {
-    pc.printf("%s", menu_item.get_name());
-}
-
-void MyRenderer::render_numeric_menu_item(NumericMenuItem const& menu_item) const {
-    string buffer;
-
-    buffer = menu_item.get_name();
-    buffer += menu_item.has_focus() ? '<' : '=';
-    buffer += menu_item.get_formatted_value();
-
-    if (menu_item.has_focus())
-        buffer += '>';
-
-    pc.printf("%s", buffer);
+void MyRenderer::write(const char* data, uint16_t size) const {
+    pc.write(data, size);
 }
 
 void MyRenderer::render_custom_numeric_menu_item(CustomNumericMenuItem const& menu_item) const {
     // This condition can be put in the CustomNumericMenuItem class as well
-    if (menu_item.has_focus()) {
+    if (menu_item.is_active()) {
         // Only display the ASCII graphics in edit mode.
 
-        string buffer;
-
         // make room for a ' ' at the end and the terminating 0
         char graphics[menu_item.get_width() + 2];
 
@@ -60,17 +27,13 @@ void MyRenderer::render_custom_numeric_menu_item(CustomNumericMenuItem const& me
             )] = '|';
         graphics[menu_item.get_width()] = ' ';
         graphics[menu_item.get_width() + 1] = 0;
-        buffer = graphics;
+        append(graphics);
 
-        buffer += menu_item.get_value();
-
-        pc.printf("%s\n", buffer);
+        char value[16];
+        menu_item.format_value(value, sizeof(value));
+        append(value);
     } else {
         // Non edit mode: Let parent class handle this
-        return render_numeric_menu_item(menu_item);
+        return render(static_cast<NumericMenuItem const&>(menu_item));
     }
 }
-
-void MyRenderer::render_menu(Menu const& menu) const {
-    pc.printf("%s", menu.get_name());
-}
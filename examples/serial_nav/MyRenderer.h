@@ -16,18 +16,21 @@
 using namespace std;
 
 #include <MenuSystem.h>
+#include <TextStreamRenderer.h>
 #include "CustomNumericMenuItem.h"
 
 class CustomNumericMenuItem;
 
-class MyRenderer : public MenuComponentRenderer {
+// Composes each frame in a buffer and sends it with a single write; in ANSI
+// mode the terminal is overwritten in place instead of scrolling.
+class MyRenderer : public TextStreamRenderer {
 public:
-    void render(Menu const& menu) const;
-    void render_menu_item(MenuItem const& menu_item) const;
-    void render_back_menu_item(BackMenuItem const& menu_item) const;
-    void render_numeric_menu_item(NumericMenuItem const& menu_item) const;
+    MyRenderer() : TextStreamRenderer(256, 6, true) {}
+
     void render_custom_numeric_menu_item(CustomNumericMenuItem const& menu_item) const;
-    void render_menu(Menu const& menu) const;
+
+protected:
+    void write(const char* data, uint16_t size) const;
 };
 
 #endif
@@ -17,13 +17,14 @@ using namespace std;
 Serial pc(USBTX, USBRX);
 
 #include <MenuSystem.h>
+#include <MenuFormat.h>
 #include "CustomNumericMenuItem.h"
 #include "MyRenderer.h"
 
 // forward declarations
-const string format_float(const float value);
-const string format_int(const float value);
-const string format_color(const float value);
+size_t format_float(const float value, char* buffer, size_t size);
+size_t format_int(const float value, char* buffer, size_t size);
+size_t format_color(const float value, char* buffer, size_t size);
 void on_component_selected(MenuComponent* p_menu_component);
 
 // Menu variables
@@ -34,45 +35,49 @@ MenuSystem ms(my_renderer);
 MenuItem mm_mi1("Level 1 - Item 1 (Item)", &on_component_selected);
 MenuItem mm_mi2("Level 1 - Item 2 (Item)", &on_component_selected);
 Menu mu1("Level 1 - Item 3 (Menu)");
-BackMenuItem mu1_mi0("Level 2 - Back (Item)", &on_component_selected, &ms);
+BackMenuItem mu1_mi0("Level 2 - Back (Item)", &ms, &on_component_selected);
 MenuItem mu1_mi1("Level 2 - Item 1 (Item)", &on_component_selected);
-NumericMenuItem mu1_mi2("Level 2 - Txt Item 2 (Item)", nullptr, 0, 0, 2, 1, format_color);
+NumericMenuItem mu1_mi2("Level 2 - Txt Item 2 (Item)", 0, 0, 2, 1);
 CustomNumericMenuItem mu1_mi3(12, "Level 2 - Cust Item 3 (Item)", 80, 65, 121, 3, format_int);
-NumericMenuItem mm_mi4("Level 1 - Float Item 4 (Item)", nullptr, 0.5, 0.0, 1.0, 0.1, format_float);
-NumericMenuItem mm_mi5("Level 1 - Int Item 5 (Item)", nullptr, 50, -100, 100, 1, format_int);
+NumericMenuItem mm_mi4("Level 1 - Float Item 4 (Item)", 0.5, 0.0, 1.0, 0.1);
+NumericMenuItem mm_mi5("Level 1 - Int Item 5 (Item)", 50, -100, 100, 1);
 
 // Menu callback function
 
 // writes the (int) value of a float into a char buffer.
-const string format_int(const float value) {
-    return to_string((int) value);
+size_t format_int(const float value, char* buffer, size_t size) {
+    return menu_format_int((int32_t) value, buffer, size);
 }
 
 // writes the value of a float into a char buffer.
-const string format_float(const float value) {
-    return to_string(value);
+size_t format_float(const float value, char* buffer, size_t size) {
+    return menu_format_fixed(value, 1, buffer, size);
 }
 
 // writes the value of a float into a char buffer as predefined colors.
-const string format_color(const float value) {
-    string buffer;
+size_t format_color(const float value, char* buffer, size_t size) {
+    const char* color;
 
     switch((int) value)
     {
         case 0:
-            buffer += "Red";
+            color = "Red";
             break;
         case 1:
-            buffer += "Green";
+            color = "Green";
             break;
         case 2:
-            buffer += "Blue";
+            color = "Blue";
             break;
         default:
-            buffer += "undef";
+            color = "undef";
     }
 
-    return buffer;
+    // snprintf returns the untruncated length
+    const int length = snprintf(buffer, size, "%s", color);
+    if (length < 0 || size == 0)
+        return 0;
+    return (size_t) length < size ? length : size - 1;
 }
 
 // In this example all menu items use the same callback.
@@ -95,32 +100,26 @@ void display_help() {
 void serial_handler() {
     char inChar;
     if ((inChar = pc.getc()) > 0) {
-        pc.printf("%s\n", "\033c");
         switch (inChar) {
             case 'w': // Previus item
                 ms.prev();
                 ms.display();
-                pc.printf("%s\n", "");
                 break;
             case 's': // Next item
                 ms.next();
                 ms.display();
-                pc.printf("%s\n", "");
                 break;
             case 'a': // Back presed
                 ms.back();
                 ms.display();
-                pc.printf("%s\n", "");
                 break;
             case 'd': // Select presed
-                ms.select();
+                ms.activate();
                 ms.display();
-                pc.printf("%s\n", "");
                 break;
             case '?':
             case 'h': // Display help
                 ms.display();
-                pc.printf("%s\n", "");
                 break;
             default:
                 break;
@@ -131,16 +130,19 @@ void serial_handler() {
 // Standard arduino functions
 
 void setup() {
-
-    ms.get_root_menu().add_item(&mm_mi1);
-    ms.get_root_menu().add_item(&mm_mi2);
-    ms.get_root_menu().add_menu(&mu1);
-    mu1.add_item(&mu1_mi0);
-    mu1.add_item(&mu1_mi1);
-    mu1.add_item(&mu1_mi2);
-    mu1.add_item(&mu1_mi3);
-    ms.get_root_menu().add_item(&mm_mi4);
-    ms.get_root_menu().add_item(&mm_mi5);
+    mu1_mi2.set_value_formatter(format_color);
+    mm_mi4.set_value_formatter(format_float);
+    mm_mi5.set_value_formatter(format_int);
+
+    ms.get_root_menu().add(&mm_mi1);
+    ms.get_root_menu().add(&mm_mi2);
+    ms.get_root_menu().add(&mu1);
+    mu1.add(&mu1_mi0);
+    mu1.add(&mu1_mi1);
+    mu1.add(&mu1_mi2);
+    mu1.add(&mu1_mi3);
+    ms.get_root_menu().add(&mm_mi4);
+    ms.get_root_menu().add(&mm_mi5);
 
     display_help();
     ms.display();
@@ -0,0 +1,114 @@
+/*
+ * table_nav.cpp - Example code using the menu system library
+ *
+ * This example shows a menu declared as a constant table. The tree lives in
+ * flash; the only RAM used is the MenuTableSystem and the numeric values.
+ * The menu is controlled over the serial port.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include <mbed.h>
+#include <stdio.h>
+
+#include <MenuTable.h>
+
+// Serial terminal
+Serial pc(USBTX, USBRX);
+
+// forward declarations
+void on_component_selected(MenuTableSystem& ms, uint8_t node_num);
+
+// Menu table
+//
+// Children of a menu are contiguous: the root's children are nodes 1..4 and
+// the "Settings" menu's children are nodes 5..7.
+
+constexpr MenuNumericRange ranges[] = {
+    // value, min, max, increment
+    {50, 0, 100, 5},
+    {3, 1, 10, 1},
+};
+
+constexpr MenuNode nodes[] = {
+    menu_node("Root", 1, 4),
+    item_node("Start", on_component_selected),
+    item_node("Stop", on_component_selected),
+    menu_node("Settings", 5, 3),
+    item_node("About", on_component_selected),
+    back_node("Back"),
+    numeric_node("Brightness", 0, on_component_selected),
+    numeric_node("Speed", 1, on_component_selected),
+};
+static_assert(menu_nodes_valid(nodes), "invalid menu table");
+
+constexpr MenuTable table = {nodes, sizeof(nodes) / sizeof(nodes[0]),
+                             ranges, sizeof(ranges) / sizeof(ranges[0])};
+
+// Renderer
+
+class MyRenderer : public MenuTableRenderer {
+public:
+    void render(MenuTableSystem const& ms) const {
+        MenuNode const& menu = ms.get_node(ms.get_current_menu());
+        pc.printf("\nCurrent menu name: %s\n", menu.name);
+        for (uint8_t i = 0; i < menu.count; ++i) {
+            const uint8_t node_num = menu.first + i;
+            MenuNode const& node = ms.get_node(node_num);
+            if (node.kind == MENU_NODE_NUMERIC)
+                pc.printf("%s%c%d%s", node.name,
+                          ms.is_active() ? '<' : '=',
+                          (int) ms.get_value(node_num),
+                          ms.is_active() ? ">" : "");
+            else
+                pc.printf("%s", node.name);
+            if (node_num == ms.get_current_node())
+                pc.printf("%s", " <<<");
+            pc.printf("\n");
+        }
+    }
+};
+MyRenderer my_renderer;
+
+// Menu variables
+
+float values[sizeof(ranges) / sizeof(ranges[0])];
+MenuTableSystem ms(table, my_renderer, values);
+
+// Menu callback function
+
+void on_component_selected(MenuTableSystem& ms, uint8_t node_num) {
+    pc.printf("%s\n", ms.get_node(node_num).name);
+}
+
+void serial_handler() {
+    char inChar;
+    if ((inChar = pc.getc()) > 0) {
+        switch (inChar) {
+            case 'w': // Previus item
+                ms.prev();
+                break;
+            case 's': // Next item
+                ms.next();
+                break;
+            case 'a': // Back presed
+                ms.back();
+                break;
+            case 'd': // Select presed
+                ms.activate();
+                break;
+            default:
+                return;
+        }
+        ms.display();
+    }
+}
+
+int main() {
+    ms.reset();
+    ms.display();
+    while(true){
+        serial_handler();
+    }
+}
@@ -0,0 +1,464 @@
+/*
+ * menugen.cpp - Generates a MenuTable header from a menu spec.
+ *
+ *     menugen [-p prefix] [-o header] spec
+ *
+ * A spec lists one component per line, nested by indenting with spaces:
+ *
+ *     # Comments and blank lines are ignored
+ *     menu "Main"
+ *       item "Start" on_activate=on_start
+ *       menu "Settings"
+ *         back "Back"
+ *         numeric "Brightness" 50 0 100 5 id=BRIGHTNESS on_activate=on_set
+ *
+ * The first line is the root menu and the only line that isn't indented.
+ * `numeric` takes the value, the minimum, the maximum and optionally the
+ * increment, 1 by default. Every component takes the optional keys
+ * on_activate= and on_current=, naming MenuNodeCbPtr callbacks, and id=,
+ * naming a node number constant. Names without spaces may be unquoted.
+ *
+ * The header, by default <prefix>_menu.h, declares:
+ *
+ *  - the callbacks, for the application to define;
+ *  - <PREFIX>_NODE_<id> node numbers and <PREFIX>_NUM_VALUES, the number of
+ *    values the MenuTableSystem needs;
+ *  - <prefix>_ranges and <prefix>_nodes, constexpr arrays listing the nodes
+ *    breadth first so the children of every menu are contiguous;
+ *  - <prefix>_menu(), returning the MenuTable.
+ *
+ * The prefix defaults to the spec's file name without its extension.
+ * Errors are reported as `spec:line: message` and write no header.
+ *
+ * Copyright (c) 2015, 2016 arduino-menusystem
+ * Licensed under the MIT license (see LICENSE)
+ */
+
+#include <MenuTable.h>
+
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+struct SpecNode {
+    int line;
+    size_t indent;
+    MenuNodeKind kind;
+    std::string name;
+    //! value, min, max and increment of a numeric node, as written
+    std::string numbers[4];
+    std::string on_activate;
+    std::string on_current;
+    std::string id;
+    std::vector<size_t> children;
+    //! Menu nesting level, 0 for the root
+    uint8_t level;
+    //! Assigned by layout: node number, first child or range slot
+    size_t node_num;
+    size_t first;
+};
+
+static const char* spec_path = "";
+static int spec_line = 0;
+
+static void fail(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    if (spec_line)
+        fprintf(stderr, "%s:%d: ", spec_path, spec_line);
+    else
+        fprintf(stderr, "%s: ", spec_path);
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+    va_end(args);
+    exit(1);
+}
+
+static bool is_identifier(std::string const& text) {
+    if (text.empty() || isdigit((unsigned char) text[0]))
+        return false;
+    for (char c : text) {
+        if (!isalnum((unsigned char) c) && c != '_')
+            return false;
+    }
+    return true;
+}
+
+// A plain decimal number strtod reads completely, so it is also a valid
+// C++ literal
+static bool is_number(std::string const& text) {
+    if (text.empty()
+        || text.find_first_not_of("0123456789+-.eE") != std::string::npos)
+        return false;
+    char* end;
+    strtod(text.c_str(), &end);
+    return *end == '\0';
+}
+
+// Splits a line into words; a quoted word may contain spaces, \" and \\.
+static std::vector<std::string> split(const char* p) {
+    std::vector<std::string> words;
+    while (true) {
+        while (*p == ' ' || *p == '\t')
+            ++p;
+        if (*p == '\0' || *p == '#')
+            return words;
+        std::string word;
+        if (*p == '"') {
+            for (++p; *p != '"'; ++p) {
+                if (*p == '\0')
+                    fail("unterminated name");
+                if (*p == '\\' && (p[1] == '"' || p[1] == '\\'))
+                    ++p;
+                word += *p;
+            }
+            ++p;
+        } else {
+            while (*p != '\0' && *p != ' ' && *p != '\t' && *p != '#')
+                word += *p++;
+        }
+        words.push_back(word);
+    }
+}
+
+static SpecNode parse_node(const char* line, size_t indent) {
+    std::vector<std::string> words = split(line + indent);
+    SpecNode node = SpecNode();
+    node.line = spec_line;
+    node.indent = indent;
+    if (words.size() < 2)
+        fail("expected a kind and a name");
+
+    std::string const& kind = words[0];
+    size_t num_numbers = 0;
+    if (kind == "menu") {
+        node.kind = MENU_NODE_MENU;
+    } else if (kind == "item") {
+        node.kind = MENU_NODE_ITEM;
+    } else if (kind == "back") {
+        node.kind = MENU_NODE_BACK;
+    } else if (kind == "numeric") {
+        node.kind = MENU_NODE_NUMERIC;
+        node.numbers[3] = "1";
+        num_numbers = 3;
+    } else {
+        fail("unknown kind '%s'", kind.c_str());
+    }
+    node.name = words[1];
+
+    size_t i = 2;
+    for (; i < words.size() && is_number(words[i]); ++i) {
+        if (i - 2 >= 4 || num_numbers == 0)
+            fail("unexpected number '%s'", words[i].c_str());
+        node.numbers[i - 2] = words[i];
+    }
+    if (i - 2 < num_numbers)
+        fail("numeric needs a value, a minimum and a maximum");
+
+    for (; i < words.size(); ++i) {
+        const size_t equals = words[i].find('=');
+        const std::string key = words[i].substr(0, equals);
+        const std::string value = equals == std::string::npos
+            ? std::string() : words[i].substr(equals + 1);
+        std::string* p_field = key == "on_activate" ? &node.on_activate
+            : key == "on_current" ? &node.on_current
+            : key == "id" ? &node.id : nullptr;
+        if (p_field == nullptr || !is_identifier(value))
+            fail("expected on_activate=, on_current= or id= and an "
+                 "identifier, not '%s'", words[i].c_str());
+        *p_field = value;
+    }
+
+    if (node.kind == MENU_NODE_NUMERIC) {
+        const double value = strtod(node.numbers[0].c_str(), nullptr);
+        const double min_value = strtod(node.numbers[1].c_str(), nullptr);
+        const double max_value = strtod(node.numbers[2].c_str(), nullptr);
+        if (!(min_value <= value && value <= max_value))
+            fail("value must lie between the minimum and the maximum");
+        if (!(strtod(node.numbers[3].c_str(), nullptr) > 0))
+            fail("increment must be positive");
+    }
+    return node;
+}
+
+static std::vector<SpecNode> parse(FILE* file) {
+    std::vector<SpecNode> nodes;
+    // The nodes enclosing the current line, innermost last
+    std::vector<size_t> open;
+    char line[1024];
+    while (fgets(line, sizeof(line), file)) {
+        ++spec_line;
+        const size_t length = strlen(line);
+        if (length == sizeof(line) - 1 && line[length - 1] != '\n')
+            fail("line too long");
+        line[strcspn(line, "\r\n")] = '\0';
+
+        const size_t indent = strspn(line, " ");
+        if (line[indent] == '\t')
+            fail("indent with spaces, not tabs");
+        if (line[indent] == '\0' || line[indent] == '#')
+            continue;
+
+        SpecNode node = parse_node(line, indent);
+        while (!open.empty() && nodes[open.back()].indent >= indent)
+            open.pop_back();
+        if (nodes.empty()) {
+            if (indent != 0 || node.kind != MENU_NODE_MENU)
+                fail("the first line must be the root menu, not indented");
+        } else if (open.empty()) {
+            fail("only the root menu may be left unindented");
+        } else {
+            SpecNode& parent = nodes[open.back()];
+            if (parent.kind != MENU_NODE_MENU)
+                fail("only menus have children; '%s' is on line %d",
+                     parent.name.c_str(), parent.line);
+            node.level = parent.level + (node.kind == MENU_NODE_MENU);
+            if (node.level >= MENU_TABLE_MAX_DEPTH)
+                fail("menus nested deeper than MENU_TABLE_MAX_DEPTH (%d)",
+                     MENU_TABLE_MAX_DEPTH);
+            parent.children.push_back(nodes.size());
+        }
+        open.push_back(nodes.size());
+        nodes.push_back(node);
+    }
+    if (nodes.empty())
+        fail("no root menu");
+    return nodes;
+}
+
+// Numbers the nodes breadth first, so that the children of every menu are
+// contiguous, and the numeric nodes' range slots in node order. Returns the
+// spec indices in node order.
+static std::vector<size_t> layout(std::vector<SpecNode>& nodes,
+                                  size_t& num_ranges) {
+    std::vector<size_t> order(1, 0);
+    for (size_t i = 0; i < order.size(); ++i) {
+        SpecNode& node = nodes[order[i]];
+        node.node_num = i;
+        if (node.kind == MENU_NODE_MENU) {
+            node.first = order.size();
+            order.insert(order.end(), node.children.begin(),
+                         node.children.end());
+        }
+    }
+    num_ranges = 0;
+    for (size_t num : order) {
+        if (nodes[num].kind == MENU_NODE_NUMERIC)
+            nodes[num].first = num_ranges++;
+    }
+
+    spec_line = 0;
+    if (order.size() > 255)
+        fail("%zu nodes; a MenuTable holds at most 255", order.size());
+    if (num_ranges > 255)
+        fail("%zu numeric nodes; a MenuTable holds at most 255", num_ranges);
+    return order;
+}
+
+static std::string quote(std::string const& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\')
+            quoted += '\\';
+        quoted += c;
+    }
+    return quoted + '"';
+}
+
+// Numbers without a fraction or exponent are written as doubles, so that
+// any integer in range converts to float in a constant expression.
+static std::string literal(std::string const& number) {
+    if (number.find_first_of(".eE") == std::string::npos)
+        return number + ".0";
+    return number;
+}
+
+static std::string to_upper(std::string text) {
+    for (char& c : text)
+        c = toupper((unsigned char) c);
+    return text;
+}
+
+static void append(std::string& out, const char* format, ...) {
+    char buffer[1024];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    out += buffer;
+}
+
+static std::string generate(std::vector<SpecNode> const& nodes,
+                            std::vector<size_t> const& order,
+                            size_t num_ranges, std::string const& prefix,
+                            const char* spec_name) {
+    const std::string upper = to_upper(prefix);
+    const char* p = prefix.c_str();
+    std::string out;
+    append(out, "// Generated by menugen from %s. Do not edit.\n\n", spec_name);
+    append(out, "#ifndef %s_MENU_H\n#define %s_MENU_H\n\n",
+           upper.c_str(), upper.c_str());
+    out += "#include <MenuTable.h>\n\n";
+
+    // Callbacks, in order of first use
+    std::vector<std::string> callbacks;
+    for (size_t num : order) {
+        for (std::string const* p_name :
+             {&nodes[num].on_activate, &nodes[num].on_current}) {
+            if (!p_name->empty()
+                && std::find(callbacks.begin(), callbacks.end(), *p_name)
+                   == callbacks.end())
+                callbacks.push_back(*p_name);
+        }
+    }
+    for (std::string const& name : callbacks)
+        append(out, "void %s(MenuTableSystem& ms, uint8_t node_num);\n",
+               name.c_str());
+    if (!callbacks.empty())
+        out += "\n";
+
+    std::vector<std::string> ids;
+    for (size_t num : order) {
+        if (!nodes[num].id.empty())
+            ids.push_back(nodes[num].id);
+    }
+    if (!ids.empty()) {
+        out += "enum : uint8_t {\n";
+        for (size_t num : order) {
+            if (!nodes[num].id.empty())
+                append(out, "    %s_NODE_%s = %zu,\n", upper.c_str(),
+                       nodes[num].id.c_str(), nodes[num].node_num);
+        }
+        out += "};\n\n";
+    }
+    append(out, "//! The number of values a MenuTableSystem over %s_menu()"
+           " needs\n", p);
+    append(out, "constexpr uint8_t %s_NUM_VALUES = %zu;\n\n", upper.c_str(),
+           num_ranges);
+
+    if (num_ranges) {
+        append(out, "constexpr MenuNumericRange %s_ranges[] = {\n", p);
+        out += "    // value, min, max, increment\n";
+        for (size_t num : order) {
+            SpecNode const& node = nodes[num];
+            if (node.kind != MENU_NODE_NUMERIC)
+                continue;
+            append(out, "    {%s, %s, %s, %s},\n",
+                   literal(node.numbers[0]).c_str(),
+                   literal(node.numbers[1]).c_str(),
+                   literal(node.numbers[2]).c_str(),
+                   literal(node.numbers[3]).c_str());
+        }
+        out += "};\n\n";
+    }
+
+    append(out, "constexpr MenuNode %s_nodes[] = {\n", p);
+    for (size_t num : order) {
+        SpecNode const& node = nodes[num];
+        std::string args = quote(node.name);
+        if (node.kind == MENU_NODE_MENU)
+            append(args, ", %zu, %zu", node.first, node.children.size());
+        else if (node.kind == MENU_NODE_NUMERIC)
+            append(args, ", %zu", node.first);
+        if (!node.on_activate.empty() || !node.on_current.empty())
+            args += ", " + (node.on_activate.empty()
+                            ? std::string("nullptr") : node.on_activate);
+        if (!node.on_current.empty())
+            args += ", " + node.on_current;
+        static const char* const helpers[] = {
+            "item_node", "back_node", "numeric_node", "menu_node"
+        };
+        append(out, "    %s(%s), // %zu\n", helpers[node.kind], args.c_str(),
+               node.node_num);
+    }
+    out += "};\n";
+    append(out, "static_assert(menu_nodes_valid(%s_nodes), "
+           "\"invalid menu table\");\n\n", p);
+
+    append(out, "constexpr MenuTable %s_table = {\n", p);
+    append(out, "    %s_nodes, %zu,\n", p, order.size());
+    if (num_ranges)
+        append(out, "    %s_ranges, %zu\n};\n\n", p, num_ranges);
+    else
+        out += "    nullptr, 0\n};\n\n";
+
+    append(out, "static inline MenuTable const& %s_menu() {\n", p);
+    append(out, "    return %s_table;\n}\n\n", p);
+    append(out, "#endif\n");
+    return out;
+}
+
+static void usage() {
+    fprintf(stderr, "usage: menugen [-p prefix] [-o header] spec\n");
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    std::string prefix;
+    std::string output;
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; i += 2) {
+        if (i + 1 >= argc)
+            usage();
+        if (strcmp(argv[i], "-p") == 0)
+            prefix = argv[i + 1];
+        else if (strcmp(argv[i], "-o") == 0)
+            output = argv[i + 1];
+        else
+            usage();
+    }
+    if (i + 1 != argc)
+        usage();
+    spec_path = argv[i];
+
+    // The spec's file name without directories and extension
+    const char* spec_name = strrchr(spec_path, '/');
+    spec_name = spec_name ? spec_name + 1 : spec_path;
+    if (prefix.empty())
+        prefix = std::string(spec_name, strcspn(spec_name, "."));
+    if (!is_identifier(prefix)) {
+        fprintf(stderr, "menugen: prefix '%s' is not an identifier\n",
+                prefix.c_str());
+        return 2;
+    }
+    if (output.empty())
+        output = prefix + "_menu.h";
+
+    FILE* spec = fopen(spec_path, "r");
+    if (spec == nullptr) {
+        perror(spec_path);
+        return 1;
+    }
+    std::vector<SpecNode> nodes = parse(spec);
+    fclose(spec);
+
+    std::vector<std::string> ids;
+    for (SpecNode const& node : nodes) {
+        spec_line = node.line;
+        if (!node.id.empty()
+            && std::find(ids.begin(), ids.end(), node.id) != ids.end())
+            fail("id '%s' used twice", node.id.c_str());
+        if (!node.id.empty())
+            ids.push_back(node.id);
+    }
+
+    size_t num_ranges;
+    const std::vector<size_t> order = layout(nodes, num_ranges);
+    const std::string header = generate(nodes, order, num_ranges, prefix,
+                                        spec_name);
+
+    FILE* file = fopen(output.c_str(), "w");
+    if (file == nullptr
+        || fwrite(header.data(), 1, header.size(), file) != header.size()
+        || fclose(file) != 0) {
+        perror(output.c_str());
+        remove(output.c_str());
+        return 1;
+    }
+    return 0;
+}